@@ -0,0 +1,64 @@
+#ifndef SYNTHETICEVENTS_H
+#define SYNTHETICEVENTS_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "HepMC3/GenEvent.h"
+
+namespace eicQuickSim {
+
+// Settings of the synthetic DIS generator.
+struct SyntheticConfig {
+    double electronEnergy = 10.0;  // GeV, beam along -z
+    double hadronEnergy = 100.0;   // GeV, proton beam along +z
+    double q2Min = 1.0;            // Q2 is sampled log-uniformly in [q2Min, q2Max]
+    double q2Max = 1000.0;
+    double meanMultiplicity = 10.0; // mean number of final-state hadrons (Poisson)
+    double pionFraction = 0.6;      // share of pi+ and pi- (half each) among them
+    uint64_t seed = 1;
+};
+
+/**
+ * Deterministic generator of DIS-like HepMC3 events for offline tests and
+ * benchmarks.
+ *
+ * Every event has the two beam particles (status 4), the scattered electron
+ * (status 1) placed so that the event has the sampled Q2 and y, and a
+ * Poisson number of final-state hadrons (status 1) with exponential pT and
+ * flat pseudorapidity. The topology is what Kinematics expects; the hadron
+ * momenta are not meant to conserve energy or momentum. The same seed and
+ * settings always produce the same events.
+ */
+class SyntheticEventGenerator {
+public:
+    explicit SyntheticEventGenerator(const SyntheticConfig& config);
+
+    // Replace the contents of evt with the next event.
+    void generate(HepMC3::GenEvent& evt);
+
+    // Write nEvents events to a local .hepmc3.tree.root file.
+    // Throws std::runtime_error if the file cannot be written.
+    void writeFile(const std::string& path, long long nEvents);
+
+    const SyntheticConfig& config() const { return config_; }
+
+private:
+    SyntheticConfig config_;
+    std::mt19937_64 rng_;
+    long long eventNumber_;
+
+    int sampleHadronPid();
+};
+
+// Write a sample Analysis can read: nFiles files of eventsPerFile events
+// (file i uses seed config.seed + i) in dir, the matching file CSV and a
+// flat precalculated weights CSV (<csv>_weights.csv, weight 1). Creates dir
+// if needed and returns the path of the file CSV.
+std::string writeSyntheticSample(const SyntheticConfig& config, const std::string& dir,
+                                 int nFiles, long long eventsPerFile);
+
+} // namespace eicQuickSim
+
+#endif // SYNTHETICEVENTS_H
@@ -0,0 +1,105 @@
+#!/bin/bash
+# startup_latency.sh: compare the fixed cost of one analysis job run as a
+# ROOT macro (root -l -b -q macros/analysis_DIS.C, as the HPC jobs did) with
+# the same job run by the native eicAnalysis.
+#
+# Usage (from the repository root, with ROOT set up):
+#   benchmarks/startup_latency.sh [-b <build dir>] [-n <repetitions>] [-e <events>] [-d <work dir>]
+#
+# Both paths analyse the same small synthetic sample (eicGenerateEvents), so
+# the difference is dominated by interpreter start-up, header parsing and
+# JIT. The script prints the mean and minimum wall time of each path and
+# checks that both wrote the same binned CSV.
+
+set -u
+
+build=build
+reps=10
+events=1000
+work=""
+
+usage() {
+    echo "Usage: $0 [-b <build dir>] [-n <repetitions>] [-e <events>] [-d <work dir>]" >&2
+}
+
+while getopts "b:n:e:d:h" opt; do
+    case $opt in
+        b) build=$OPTARG ;;
+        n) reps=$OPTARG ;;
+        e) events=$OPTARG ;;
+        d) work=$OPTARG ;;
+        h) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
+build=$(cd "$build" && pwd) || exit 1
+for f in "$build/bin/eicAnalysis" "$build/bin/eicGenerateEvents" "$build/lib/libeicQuickSim.so"; do
+    if [ ! -e "$f" ]; then
+        echo "$f not found; build the project first." >&2
+        exit 1
+    fi
+done
+if ! command -v root > /dev/null; then
+    echo "root not found; run this inside the EIC shell." >&2
+    exit 1
+fi
+if [ -z "$work" ]; then
+    work=$(mktemp -d)
+    trap 'rm -rf "$work"' EXIT
+fi
+mkdir -p "$work"
+work=$(cd "$work" && pwd)
+
+"$build/bin/eicGenerateEvents" -o "$work/sample" -n 1 -e "$events" -E 10x100 > /dev/null || exit 1
+
+config() { # <output csv>
+    cat <<EOF
+analysis_type: "DIS"
+energy_config: "10x100"
+csv_source: "$work/sample/synthetic.csv"
+max_events: $events
+collision_type: "ep"
+binning_scheme: "$PWD/src/bins/example.yaml"
+output_csv: "$1"
+EOF
+}
+config "$work/macro.csv" > "$work/macro.yaml"
+config "$work/native.csv" > "$work/native.yaml"
+
+# The production macro, loading the library of the chosen build directory.
+sed -e "s#build/lib/#$build/lib/#" -e "s#R__ADD_INCLUDE_PATH(src/eicQuickSim)#R__ADD_INCLUDE_PATH($PWD/src/eicQuickSim)#" \
+    macros/analysis_DIS.C > "$work/analysis_DIS.C"
+
+# Runs a command reps times; prints "<mean> <min>" in seconds.
+measure() {
+    local times=()
+    for ((i = 0; i < reps; ++i)); do
+        local start end
+        start=$(date +%s.%N)
+        if ! "$@" > "$work/last.log" 2>&1; then
+            echo "Command failed: $*" >&2
+            cat "$work/last.log" >&2
+            exit 1
+        fi
+        end=$(date +%s.%N)
+        times+=("$(awk -v a="$start" -v b="$end" 'BEGIN { printf "%.6f", b - a }')")
+    done
+    printf '%s\n' "${times[@]}" | awk '{ s += $1; if (NR == 1 || $1 < m) m = $1 } END { printf "%.3f %.3f\n", s / NR, m }'
+}
+
+echo "Timing $reps runs of each path over $events events..."
+read -r macroMean macroMin < <(measure root -l -b -q "$work/analysis_DIS.C(\"$work/macro.yaml\")")
+read -r nativeMean nativeMin < <(measure "$build/bin/eicAnalysis" DIS "$work/native.yaml")
+# measure() exits in a subshell on failure; nothing is read then.
+[ -n "${macroMean:-}" ] && [ -n "${nativeMean:-}" ] || exit 1
+
+printf '%-28s %10s %10s\n' "path" "mean [s]" "min [s]"
+printf '%-28s %10s %10s\n' "root macros/analysis_DIS.C" "$macroMean" "$macroMin"
+printf '%-28s %10s %10s\n' "eicAnalysis DIS" "$nativeMean" "$nativeMin"
+echo "Saved per job: $(awk -v a="$macroMean" -v b="$nativeMean" 'BEGIN { printf "%.3f", a - b }') s"
+
+if ! cmp -s "$work/macro.csv" "$work/native.csv"; then
+    echo "The two paths wrote different results ($work/macro.csv, $work/native.csv)." >&2
+    exit 1
+fi
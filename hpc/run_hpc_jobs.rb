@@ -15,6 +15,10 @@
 #   --pid            Final state hadron pid (required for SIDIS)
 #   --pid1           First hadron pid (required for DISIDIS)
 #   --pid2           Second hadron pid (required for DISIDIS)
+#   -t, --threads    Worker threads per job (default: 1)
+#   --events-per-shard N
+#                    Split input files into shards of at most N events; each
+#                    shard is one batch row (first_entry,n_entries columns)
 #   --no-slurm       Disable SLURM submission and run jobs locally
 #   -h, --help       Display this help message
 
@@ -34,7 +38,9 @@ options = {
   no_slurm: false,   # run locally if true (otherwise use SLURM if available)
   pid: nil,          # for SIDIS
   pid1: nil,         # for DISIDIS
-  pid2: nil          # for DISIDIS
+  pid2: nil,         # for DISIDIS
+  threads: 1,        # worker threads per job
+  events_per_shard: nil # split files into event ranges of this size
 }
 
 opts = OptionParser.new do |opts|
@@ -64,6 +70,14 @@ opts = OptionParser.new do |opts|
     options[:pid2] = pid2
   end
 
+  opts.on("-t NUM", "--threads=NUM", Integer, "Worker threads per job. Default: 1") do |num|
+    options[:threads] = num
+  end
+
+  opts.on("--events-per-shard=N", Integer, "Split input files into shards of at most N events") do |num|
+    options[:events_per_shard] = num
+  end
+
   opts.on("--no-slurm", "Disable SLURM submission; run jobs locally") do
     options[:no_slurm] = true
   end
@@ -97,6 +111,18 @@ if options[:num_files].nil? || options[:num_files] <= 0
   exit 1
 end
 
+if options[:threads] <= 0
+  puts "Error: The number of threads (-t) must be positive."
+  puts opts
+  exit 1
+end
+
+if !options[:events_per_shard].nil? && options[:events_per_shard] <= 0
+  puts "Error: --events-per-shard must be positive."
+  puts opts
+  exit 1
+end
+
 if options[:analysis] == "SIDIS" && options[:pid].nil?
   puts "Error: For SIDIS analysis, you must specify --pid."
   puts opts
@@ -117,7 +143,7 @@ analysis_type = options[:analysis]
 ACCOUNT = "clas12"
 PARTITION = "production"
 MEM_PER_CPU = 2000    # in MB
-CPUS_PER_TASK = 1
+CPUS_PER_TASK = options[:threads]
 TIME_LIMIT = "24:00:00"
 
 # -------------------------
@@ -139,8 +165,10 @@ Dir.glob(File.join(base_dir, "config_*")).each do |config_dir|
 
   root_dir = File.join(config_dir, "root")
   csv_dir = File.join(config_dir, "csv")
+  state_dir = File.join(config_dir, "state")
   FileUtils.mkdir_p(root_dir)
   FileUtils.mkdir_p(csv_dir)
+  FileUtils.mkdir_p(state_dir)
   puts "Processing config directory: #{config_dir}"
 
   # Batches subdirectory in each configuration directory
@@ -203,15 +231,41 @@ Dir.glob(File.join(base_dir, "config_*")).each do |config_dir|
     energy_config  = "unknown"
   end
 
+  # Work units: whole files, or event ranges of them when sharding. The
+  # weights are precalculated over the whole files.csv, so splitting a file
+  # does not change its normalisation.
+  batch_headers = csv_data.headers
+  work_units = csv_data.map(&:fields)
+  if options[:events_per_shard]
+    shard_size = options[:events_per_shard]
+    n_events_col = csv_data.headers.index("n_events")
+    # The shard columns follow the (optional) weight column.
+    has_weight = csv_data.headers.include?("weight")
+    batch_headers = csv_data.headers + (has_weight ? [] : ["weight"]) + ["first_entry", "n_entries"]
+    work_units = []
+    csv_data.each do |row|
+      fields = has_weight ? row.fields : row.fields + [-1]
+      n_events = n_events_col ? row["n_events"].to_i : 0
+      if n_events <= shard_size
+        work_units << fields + [0, -1]
+        next
+      end
+      (0...n_events).step(shard_size) do |first|
+        work_units << fields + [first, [shard_size, n_events - first].min]
+      end
+    end
+    puts "Split #{csv_data.size} files into #{work_units.size} shards of up to #{shard_size} events."
+  end
+
   batch_number = 1
-  csv_data.each_slice(n_per_job) do |rows|
+  work_units.each_slice(n_per_job) do |rows|
     batch_index = format('%04d', batch_number)
     batch_csv_path = File.join(batch_dir, "batch#{batch_index}.csv")
     puts "Writing #{batch_csv_path} with #{rows.size} rows..."
 
     # Write the batch CSV (include header)
     CSV.open(batch_csv_path, "w") do |csv|
-      csv << csv_data.headers
+      csv << batch_headers
       rows.each { |row| csv << row }
     end
 
@@ -229,12 +283,17 @@ Dir.glob(File.join(base_dir, "config_*")).each do |config_dir|
     yaml_config = {
       "analysis_type"  => "#{analysis_type}", 
       "energy_config"  => energy_config,
-      "csv_source"     => File.expand_path(input_csv),
+      "csv_source"     => File.expand_path(batch_csv_path),
       "max_events"     => max_event,
       "collision_type" => collision_type,
       "binning_scheme" => "src/bins/example.yaml",
       "output_csv"     => File.join(csv_dir, "analysis_#{analysis_type}_#{collision_type}_#{energy_config}_batch#{batch_index}.csv"),
-      "output_tree"    => File.join(root_dir, "analysis_#{analysis_type}_#{collision_type}_#{energy_config}_batch#{batch_index}.root")
+      "output_tree"    => File.join(root_dir, "analysis_#{analysis_type}_#{collision_type}_#{energy_config}_batch#{batch_index}.root"),
+      "output_state"   => File.join(state_dir, "analysis_#{analysis_type}_#{collision_type}_#{energy_config}_batch#{batch_index}.bstate"),
+      "checkpoint"     => File.join(state_dir, "analysis_#{analysis_type}_#{collision_type}_#{energy_config}_batch#{batch_index}.ckpt"),
+      "checkpoint_seconds" => 600,
+      "run_report"     => File.join(state_dir, "analysis_#{analysis_type}_#{collision_type}_#{energy_config}_batch#{batch_index}.report.json"),
+      "n_threads"      => options[:threads]
     }
     batch_yaml_file = File.join(batch_dir, "batch#{batch_index}_config.yaml")
     File.open(batch_yaml_file, "w") { |file| file.write(YAML.dump(yaml_config)) }
@@ -281,6 +340,12 @@ file.puts "#!/bin/bash"
 end
 
 
+# Jobs run the native eicAnalysis when it has been built; otherwise they
+# fall back to the ROOT macro of the analysis type.
+native_cli = File.join("build", "bin", "eicAnalysis")
+use_native = File.executable?(native_cli)
+puts(use_native ? "Jobs will run #{native_cli}." : "#{native_cli} not found; jobs will run the ROOT macros.")
+
 # Set the analysis macro file based on the analysis type.
 macro = case analysis_type
         when "DIS" then "macros/analysis_DIS.C"
@@ -338,7 +403,16 @@ Dir.glob(File.join(base_dir, "config_*")).each do |config_dir|
                    %Q{"#{File.expand_path(yaml_config)}", #{options[:pid1]}, #{options[:pid2]}}
                  end
 
-    root_cmd = %Q{root -l -b -q '#{macro}\(#{cmd_params}\)'}
+    root_cmd = if use_native
+                 native_args = case analysis_type
+                               when "DIS" then ""
+                               when "SIDIS" then " --pid #{options[:pid]}"
+                               when "DISIDIS" then " --pid1 #{options[:pid1]} --pid2 #{options[:pid2]}"
+                               end
+                 %Q{#{native_cli} #{analysis_type} "#{File.expand_path(yaml_config)}"#{native_args}}
+               else
+                 %Q{root -l -b -q '#{macro}\(#{cmd_params}\)'}
+               end
 
 
 
@@ -360,6 +434,8 @@ Dir.glob(File.join(base_dir, "config_*")).each do |config_dir|
     f.puts "#SBATCH --time=#{TIME_LIMIT}"
     f.puts "#SBATCH --output=#{slurm_output}"
     f.puts "#SBATCH --error=#{slurm_error}"
+    f.puts "#SBATCH --requeue"
+    f.puts "#SBATCH --open-mode=append"
     f.puts ""
     f.puts "cd #{Dir.pwd}"
     f.puts "../eic-shell3/eic-shell -- #{shell_script}"
@@ -385,6 +461,8 @@ end
 puts "All analysis jobs processed for project '#{project_name}'.\n\n"
 puts "SLURM job submission commands have been saved to #{run_jobs_file}."
 puts "To submit all jobs, run: \n\n bash #{run_jobs_file} OUTSIDE OF EIC-SHELL\n\n"
+puts "Once they have finished, reduce each configuration's batches with:\n\n"
+puts " ./build/bin/eicMergeBins -s src/bins/example.yaml -o <config dir>/analysis_merged.csv <config dir>/state/*.bstate\n\n"
 
 last_line = File.readlines(current_slurm_script).last.chomp
 if match = last_line.match(/(hpc\/.*)/)
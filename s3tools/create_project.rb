@@ -81,17 +81,23 @@ energy_configs.each do |energy_config|
     # Define an output CSV file for preprocess_HPC.
     output_csv = File.join(config_dir, "files.csv")
 
-    # Construct the ROOT macro command for preprocess_HPC:
-    # It takes arguments: energy_config (string), num_files (int), max_events (int),
+    # Construct the preprocessing command: the native eicAnalysis if it has
+    # been built, otherwise the ROOT macro preprocess_HPC, which takes
+    # energy_config (string), num_files (int), max_events (int),
     # collision (string), output_csv (string)
-    command = %Q{root -l -b -q 'macros/preprocess_HPC.C\(\"#{energy_config}\", #{num_files}, #{max_events}, \"#{collision}\", \"#{output_csv}\"\)'}
+    native_cli = File.join("build", "bin", "eicAnalysis")
+    command = if File.executable?(native_cli)
+                %Q{#{native_cli} preprocess -e #{energy_config} -f #{num_files} -m #{max_events} -c #{collision} -o "#{output_csv}"}
+              else
+                %Q{root -l -b -q 'macros/preprocess_HPC.C\(\"#{energy_config}\", #{num_files}, #{max_events}, \"#{collision}\", \"#{output_csv}\"\)'}
+              end
     
     puts "Processing project '#{project_name}' (#{collision} - #{energy_config}):"
     puts "  CSV output -> #{output_csv}"
     puts "  Running: #{command}"
     
     unless system(command)
-      puts "Error: ROOT command failed for configuration #{collision} #{energy_config}!"
+      puts "Error: preprocessing failed for configuration #{collision} #{energy_config}!"
       exit 1
     end
     puts "  Finished processing for configuration #{collision} #{energy_config}."
@@ -0,0 +1,107 @@
+#ifndef ADAPTIVEBUDGET_H
+#define ADAPTIVEBUDGET_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BinningScheme.h"
+#include "FileManager.h"
+#include "Weights.h"
+
+namespace eicQuickSim {
+
+/**
+ * Event budget of a precision-targeted run: instead of reading max_events
+ * from every file, read each Q2 group of files only until the bins it
+ * contributes to reach a target relative uncertainty.
+ *
+ * The input rows are cut into chunks of a few thousand events, interleaved
+ * over the Q2 groups so that all groups advance together. After every chunk
+ * the relative uncertainty sqrt(sumw2)/sumw of the target bins is
+ * re-evaluated; a group whose target bins have all converged (or, with a
+ * combined target, once their sum has converged) gets no further chunks.
+ * Files are never read beyond max_events.
+ *
+ * The event weights depend on how many events of each Q2 group are used,
+ * which is only known at the end. Events are therefore binned with the
+ * planned weights, separately for every Q2 weight range, and each range is
+ * rescaled by actual/planned weight (see Weights::setEntries) in finish()
+ * and for every convergence check. The result is normalised exactly as if
+ * the used events had been the planned input.
+ */
+class AdaptiveBudget {
+public:
+    struct Target {
+        double relError = 0;            // target sqrt(sumw2)/sumw; 0 disables
+        bool combined = false;          // target the sum over the bins, not each bin
+        std::vector<std::string> bins;  // bin keys as in BinningScheme::makeBinKey; empty = all
+        long long chunkEvents = 10000;  // events per chunk
+
+        bool enabled() const { return relError > 0; }
+    };
+
+    // rows are the input files or shards, read up to maxEvents entries each.
+    // Throws std::runtime_error for an invalid bin key.
+    AdaptiveBudget(const Target& target, const std::vector<CSVRow>& rows, int maxEvents,
+                   const BinningScheme& scheme);
+
+    // The work units: the rows cut into chunks, interleaved over the groups.
+    const std::vector<CSVRow>& chunks() const { return m_chunks; }
+
+    // Q2 weight ranges: events are binned per range, see addChunk().
+    size_t numRanges() const { return m_plan->getNumRanges(); }
+    size_t rangeOf(double Q2) const { return m_plan->getRangeIndex(Q2); }
+
+    // False once the group of the chunk no longer needs events.
+    bool wanted(size_t chunk) const;
+    // Account for a processed chunk: ranges[r] holds the entries of its
+    // events in Q2 range r, binned with the planned weights. The schemes
+    // are cleared for reuse. Thread-safe.
+    void addChunk(size_t chunk, long long events, const std::vector<BinningScheme*>& ranges);
+    // Account for a chunk that could not be read completely: the entries it
+    // left in ranges are discarded (the schemes are cleared) and its events
+    // are no longer expected. Thread-safe.
+    void dropChunk(size_t chunk, const std::vector<BinningScheme*>& ranges);
+
+    // Add the normalised result to scheme. Throws std::runtime_error if a
+    // Q2 range received no events at all, so it cannot be normalised.
+    void finish(BinningScheme& scheme) const;
+
+    // Events used and available per group, and whether it converged.
+    void printSummary(std::ostream& os) const;
+    long long eventsUsed() const;
+    long long eventsAvailable() const;
+    size_t convergedGroups() const;
+
+private:
+    struct Group {
+        CSVGroupSummary summary; // events: the planned events
+        long long used = 0;
+        long long remaining = 0; // planned events of chunks not yet done
+        bool converged = false;
+        std::vector<char> hits;  // target bins this group filled
+    };
+
+    Target m_target;
+    std::vector<CSVRow> m_chunks;
+    std::vector<size_t> m_chunkGroup;
+    std::vector<Group> m_groups;
+    std::vector<uint64_t> m_targetBins;
+    std::unique_ptr<Weights> m_plan;    // weights of the planned events
+    std::unique_ptr<Weights> m_actual;  // updated to the used events
+    std::vector<std::unique_ptr<BinningScheme>> m_ranges; // per Q2 range
+    mutable std::mutex m_mutex;
+
+    // Rescale factor of every range for the events used so far; false if a
+    // group has no events yet.
+    bool rangeFactors(std::vector<double>& factors) const;
+    void updateConvergence();
+};
+
+} // namespace eicQuickSim
+
+#endif // ADAPTIVEBUDGET_H
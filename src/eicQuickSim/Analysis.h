@@ -4,12 +4,22 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <mutex>
+#include <atomic>
 #include "FileManager.h"
 #include "Kinematics.h"
+#include "BranchReader.h"
 #include "TreeManager.h"
 #include "Weights.h"
 #include "BinningScheme.h"
 #include "CombinedRowsProcessor.h"
+#include "KinematicsCache.h"
+#include "EventPipeline.h"
+#include "ColumnReader.h"
+#include "FileCache.h"
+#include "Checkpoint.h"
+#include "Instrumentation.h"
+#include "AdaptiveBudget.h"
 #include "HepMC3/GenEvent.h"
 #include "HepMC3/ReaderRootTree.h"
 
@@ -21,9 +31,12 @@ class Analysis {
 public:
     Analysis();
     ~Analysis();
-    void initFromYaml(const std::string& yamlFile);
+    // Returns false (after printing the reason) if the YAML cannot be read
+    // or lacks a required key.
+    bool initFromYaml(const std::string& yamlFile);
     // Setters for each parameter.
     void setAnalysisType(const std::string& analysisType);
+    const std::string& getAnalysisType() const { return m_analysisType; }
     void setEnergyConfig(const std::string& energyConfig);
     void setCSVSource(const std::string& csvSource); // number of files or CSV path.
     void setCSVWeights(const std::string& csvWeights); // CSV containing Q2 weights
@@ -31,8 +44,43 @@ public:
     void setCollisionType(const std::string& collisionType);
     void setBinningSchemePath(const std::string& pathToBinScheme);
     void setOutputCSV(const std::string& outputCSV);
+    // Also save the binned state (see BinningScheme::saveState) for exact
+    // merging of batch outputs with eicMergeBins.
+    void setOutputState(const std::string& outputState);
+    // Write the binned CSV in end() (default: true). Turn it off when only
+    // the binned state is needed.
+    void setSaveCSV(bool saveCSV);
     void setSIDISPid(int pid);
     void setDISIDISPids(int pid1, int pid2);
+    // Number of worker threads used by run(). Files are handed out to the
+    // workers one at a time; 1 (the default) processes everything serially.
+    void setNumThreads(int nThreads);
+    // Read input files ahead of the compute threads (see EventPipeline):
+    // prefetchFiles files are opened and decoded concurrently, each into a
+    // queue of queueSize events. prefetchFiles = 0 (the default) reads the
+    // files directly in the worker threads.
+    void setPrefetch(int prefetchFiles, size_t queueSize = 64);
+    // Read only the particle columns of the input trees (see ColumnReader)
+    // instead of decoding full GenEvents. Files the column reader cannot
+    // handle are read as GenEvents. Ignored when prefetching.
+    void setColumnInput(bool columnInput);
+    // Copy remote inputs (root://, ...) into a node-local cache directory
+    // shared by the jobs on the node, holding at most maxBytes (see
+    // FileCache), and read them from there.
+    void setFileCache(const std::string& dir, uint64_t maxBytes);
+    // Use these work units instead of loading them from the CSV source.
+    // Rows may be shards (see CSVRow::firstEntry/nEntries); the weights are
+    // still taken from setCSVWeights()/setCSVSource().
+    void setInputRows(const std::vector<CSVRow>& rows);
+    // Split every input file into shards of at most eventsPerShard events so
+    // that the workers can share a single large file. 0 (the default) keeps
+    // one work unit per row.
+    void setEventsPerShard(long long eventsPerShard);
+    // Instead of reading max_events from every file, read each Q2 group only
+    // until the target bins reach the given relative uncertainty (see
+    // AdaptiveBudget). Not available together with tree output, checkpoints,
+    // a kinematics cache or prefetching.
+    void setPrecisionTarget(const AdaptiveBudget::Target& target);
 
     // For DIS: set a custom value function that extracts a vector<double> from disKinematics.
     void setDISValueFunction(std::function<std::vector<double>(const disKinematics&)> func);
@@ -40,14 +88,64 @@ public:
     void setSIDISValueFunction(std::function<std::vector<double>(const sidisKinematics&)> func);
     // For DISIDIS: set a custom value function that extracts a vector<double> from dihadronKinematics.
     void setDihadValueFunction(std::function<std::vector<double>(const dihadronKinematics&)> func);
+    // Allocation-free alternatives to the value functions above: write the
+    // values of one entry (one per scheme dimension) to out.
+    void setDISValueWriter(std::function<void(const disKinematics&, double*)> func);
+    void setSIDISValueWriter(std::function<void(const sidisKinematics&, double*)> func);
+    void setDihadValueWriter(std::function<void(const dihadronKinematics&, double*)> func);
 
+    // Write the per-event kinematics to a TTree. The file is created when
+    // the run starts.
     void enableTreeOutput(const std::string& treeOutputFile);
+    // Compression, precision, branch selection and async writing of the
+    // tree output (see TreeOptions).
+    void setTreeOptions(const TreeOptions& options);
+
+    // Save the run's progress to checkpointPath every everyEvents events or
+    // everySeconds seconds (0 disables a trigger). If run() finds a
+    // checkpoint of the same configuration there, it resumes from it instead
+    // of starting over; the checkpoint is deleted once end() has saved the
+    // outputs. Not available together with a kinematics cache.
+    void setCheckpoint(const std::string& checkpointPath, long long everyEvents, double everySeconds = 0);
+
+    // Keep the computed kinematics in a local columnar cache (see
+    // KinematicsCache). mode is "build" (read the HepMC3 files and rewrite the
+    // cache), "replay" (bin straight from the cache; abort if it is missing or
+    // stale) or "auto" (replay when the cache is valid, build it otherwise).
+    void setKinematicsCache(const std::string& cachePath, const std::string& mode = "auto");
+
+    // Write a JSON report of the run to reportPath in end(): time per stage
+    // (see Instrumentation.h), events/s, entries per event, out-of-range
+    // rejections, bytes read, peak RSS and per-file statistics.
+    void setRunReport(const std::string& reportPath);
     
+    // The work units run() would process: the input rows, sharded if
+    // requested.
+    std::vector<CSVRow> listInputRows();
+
+    // True if every required input is set, including the pids the analysis
+    // type needs; prints what is missing otherwise. run() checks this first.
+    bool checkInputs() const;
+
     // Run the analysis (process events) and then call end() to save the CSV.
-    void run();
-    void end();
+    // Returns false if the run could not start (missing inputs, unreadable
+    // weights or binning scheme); end() must not be called then.
+    bool run();
+    // Save the outputs; returns false if one of them could not be written.
+    bool end();
+
+    // Input files of the last run() that could not be opened or read completely.
+    int getFailedFiles() const { return m_failedFiles; }
 
 private:
+    // MultiAnalysis drives several analyses through their per-event interface.
+    friend class MultiAnalysis;
+
+    // Tree entries are handed to the shared TreeManager in batches of this size.
+    static const size_t kTreeFlushSize = 4096;
+    // Events read per ColumnReader batch.
+    static const size_t kColumnBatchSize = 256;
+
     // Input parameters.
     std::string m_analysisType;  // "DIS", "SIDIS", or "DISIDIS"
     std::string m_energyConfig;
@@ -56,6 +154,8 @@ private:
     std::string m_collisionType;
     std::string m_binningSchemePath;
     std::string m_outputCSV;
+    std::string m_outputState;
+    bool m_saveCSV;
     std::string m_weightsPath;
 
     // For SIDIS.
@@ -65,20 +165,153 @@ private:
     int m_dihad_pid1;
     int m_dihad_pid2;
 
-    // User-defined value functions.
+    int m_nThreads;
+    int m_prefetchFiles;
+    size_t m_eventQueueSize;
+    bool m_columnInput;
+    std::string m_fileCacheDir;
+    uint64_t m_fileCacheBytes;
+    FileCache* m_fileCache; // only set while run() is reading files
+    EventPipeline* m_pipeline; // only set while run() is reading files
+    bool m_rowsProvided;       // m_combinedRows was set with setInputRows()
+    long long m_eventsPerShard;
+    // Precision-targeted event budget; m_budget only exists during a run
+    // with a target.
+    AdaptiveBudget::Target m_precisionTarget;
+    AdaptiveBudget* m_budget;
+
+    // Kinematics::Field flags the binning and tree output actually read.
+    unsigned m_requiredFields;
+    // Scheme dimensions binned directly in a DIS variable, with the matching
+    // member. Events outside any of these ranges cannot fill a bin.
+    std::vector<std::pair<size_t, double disKinematics::*>> m_disRangeCuts;
+    // Likewise the binned z_pair and Mh ranges, for dihadron pairs.
+    Kinematics::PairSelection m_pairSelection;
+
+    // Kinematics cache.
+    std::string m_cachePath;
+    std::string m_cacheMode;
+    KinematicsCache m_cache;
+    bool m_replayCache;
+
+    // User-defined value functions, and the writers the event loop calls
+    // (user-defined, wrapping a value function, or generated from the
+    // scheme's branches).
     std::function<std::vector<double>(const disKinematics&)> m_disValueFunction;
     std::function<std::vector<double>(const sidisKinematics&)> m_sidisValueFunction;
     std::function<std::vector<double>(const dihadronKinematics&)> m_dihadValueFunction;
+    std::function<void(const disKinematics&, double*)> m_disValueWriter;
+    std::function<void(const sidisKinematics&, double*)> m_sidisValueWriter;
+    std::function<void(const dihadronKinematics&, double*)> m_dihadValueWriter;
 
     // Data members.
     std::vector<CSVRow> m_combinedRows;
     Weights* m_q2Weights;
     BinningScheme* m_binScheme;
+    std::string m_treeOutputPath;
+    TreeOptions m_treeOptions;
     TreeManager* m_treeManager;
 
+    // Checkpointing. m_rowBase holds the entries of each row done before
+    // this run (when resuming), m_rowProgress those read in this run and
+    // m_rowDone the completed rows; a row's entries are only written by the
+    // worker processing it.
+    Checkpoint m_checkpoint;
+    bool m_checkpointActive;
+    uint64_t m_runFingerprint;
+    std::vector<long long> m_rowBase;
+    std::vector<long long> m_rowProgress;
+    std::vector<char> m_rowDone;
+    long long m_resumeTreeEntries;
+
+    // Run report. m_runStats collects the workers' statistics in end().
+    std::string m_reportPath;
+    RunStats m_runStats;
+    double m_wallSeconds;
+    std::map<std::string, double> m_reportExtra;
+
+    // State owned by a single worker thread. Each worker bins into its own
+    // copy of the binning scheme and buffers its tree entries, so the event
+    // loop itself needs no locking. The accumulators are reduced in end().
+    // The event, particle index, kinematics and value buffer are reused for
+    // every event, so the loop does not allocate once they have grown.
+    // With a precision target the worker owns one scheme per Q2 weight range
+    // instead, and binScheme points at the range of the current event.
+    struct Worker {
+        BinningScheme* binScheme;
+        std::vector<BinningScheme*> rangeSchemes;
+        TreeBuffer treeBuffer;
+        KinematicsCache::Section cacheSection;
+        HepMC3::GenEvent event;
+        ColumnReader::Batch columns;
+        ParticleIndex index;
+        Kinematics kin;
+        std::vector<double> values;
+        long long checkpointTicks = 0;
+        RunStats stats;
+        FileStats currentFile;
+        std::chrono::steady_clock::time_point fileStart;
+        std::function<void(const disKinematics&, double*)> disValueWriter;
+        std::function<void(const sidisKinematics&, double*)> sidisValueWriter;
+        std::function<void(const dihadronKinematics&, double*)> dihadValueWriter;
+    };
+    std::vector<Worker*> m_workers;
+    std::mutex m_logMutex;
+    std::atomic<int> m_failedFiles;
+
     // Internal functions.
-    bool checkInputs() const;
-    void loadCSVRows();
+    void loadCSVRows();  // input rows, sharded if requested
+    void readCSVRows();  // rows from the CSV source
+    bool prepare();
+    bool setupBudget();
+    void createWorkers(int nWorkers);
+    void clearWorkers();
+    void flushTreeBuffer(Worker& worker);
+    void beginFileStats(const std::string& filename, Worker& worker);
+    void endFileStats(Worker& worker);
+    void writeRunReport();
+    void processFile(size_t rowIndex, Worker& worker);
+    // Drop what a row that failed partway left in the worker's buffers.
+    void abandonRow(size_t rowIndex, Worker& worker);
+    // How reading an input file ended. Failed files are counted in
+    // m_failedFiles; their rows are not complete.
+    enum class ReadStatus { Done, Unavailable, Failed };
+    // Called once worker.index holds the next event, with the number of
+    // events read from the file so far.
+    using EventCallback = std::function<void(long long)>;
+    // Read the entries [firstEntry, lastEntry) of a row's file, from the
+    // file cache and with the column reader when enabled, calling onEvent
+    // for each. Shared by processFile() and MultiAnalysis.
+    ReadStatus readInput(size_t rowIndex, long long firstEntry, long long lastEntry,
+                         Worker& worker, const EventCallback& onEvent, long long& eventsParsed);
+    // Read a file as GenEvents. Fails if it cannot be opened.
+    ReadStatus processFileEvents(size_t rowIndex, const std::string& inputPath,
+                                 long long firstEntry, long long lastEntry,
+                                 Worker& worker, const EventCallback& onEvent,
+                                 long long& eventsParsed);
+    // Read a file through the ColumnReader. Returns Unavailable, before any
+    // event is processed, if it has to be read as GenEvents instead, and
+    // fails if an entry cannot be read.
+    ReadStatus processFileColumns(size_t rowIndex, const std::string& inputPath,
+                                  long long firstEntry, long long lastEntry,
+                                  Worker& worker, const EventCallback& onEvent,
+                                  long long& eventsParsed);
+    void processEvent(const HepMC3::GenEvent& evt, Worker& worker);
+    // Compute the DIS kinematics of worker.index and bin the event.
+    void processIndexedEvent(Worker& worker);
+    // Bin one event whose DIS kinematics kin has already computed.
+    void consumeEvent(Kinematics& kin, const ParticleIndex& index, Worker& worker);
+    bool setupCache();
+    // Create m_fileCache if a cache directory is set; closeFileCache()
+    // reports its counters and deletes it.
+    void openFileCache();
+    void closeFileCache();
+    void resumeFromCheckpoint();
+    Checkpoint::Progress collectProgress();
+    void checkpointTick(size_t rowIndex, long long eventsParsed, Worker& worker);
+    void replaySection(size_t section, Worker& worker);
+    void configureRequiredFields(bool autoValueFunction);
+    bool passesDISRange(const disKinematics& dis) const;
 
     // --- Helper functions for auto-generating value functions ---
     // These functions map a branch name (from the YAML) to a value from the struct.
@@ -86,8 +319,10 @@ private:
     static double getValueDIS(const disKinematics& dis, const std::string& branch);
     static double getValueSIDIS(const sidisKinematics& sid, const std::string& branch);
     static double getValueDihad(const dihadronKinematics& dih, const std::string& branch);
+    // Kinematics::Field flags needed to provide the given branches.
+    static unsigned requiredFieldsFor(const std::vector<std::string>& branches);
 
-    // Auto-generate a DIS value function based on the bin scheme.
+    // Auto-generate a DIS value writer based on the bin scheme.
     void autoSetDISValueFunction();
     void autoSetSIDISValueFunction();
     void autoSetDihadValueFunction();
@@ -0,0 +1,100 @@
+#ifndef BINACCUMULATOR_H
+#define BINACCUMULATOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Numeric storage for binned event counts, addressed by a row-major linear
+ * bin index (see BinningScheme). Each bin holds the sum of weights, the sum
+ * of squared weights and the number of entries filled into it.
+ *
+ * Schemes with up to kMaxDenseBins bins are stored as a dense array, so a
+ * fill is a single indexed add. Larger (very high-dimensional) schemes fall
+ * back to an open-addressing hash table keyed by the packed linear index,
+ * which only grows when a previously unseen bin is filled. Every worker
+ * thread holds its own accumulator, so the dense limit (24 bytes per bin,
+ * about 6 MB at kMaxDenseBins) bounds the per-worker memory of large schemes.
+ */
+class BinAccumulator {
+public:
+    static const uint64_t kMaxDenseBins = 1ull << 18;
+
+    explicit BinAccumulator(uint64_t nBins = 0);
+
+    // Drop all contents and resize for a scheme with nBins bins.
+    void reset(uint64_t nBins);
+
+    // Add weight to the given bin (bin < size()).
+    inline void fill(uint64_t bin, double weight) {
+        size_t slot = dense_ ? bin : sparseSlot(bin);
+        values_[slot] += weight;
+        sumw2_[slot] += weight * weight;
+        ++entries_[slot];
+    }
+
+    // Add precomputed sums (e.g. read from a saved state) to the given bin.
+    inline void fillSums(uint64_t bin, double sumw, double sumw2, uint64_t entries) {
+        size_t slot = dense_ ? bin : sparseSlot(bin);
+        values_[slot] += sumw;
+        sumw2_[slot] += sumw2;
+        entries_[slot] += entries;
+    }
+
+    // Sum of weights in the given bin (0 if it was never filled).
+    double get(uint64_t bin) const;
+    // Sum of squared weights in the given bin.
+    double getSumW2(uint64_t bin) const;
+    // Number of entries filled into the given bin.
+    uint64_t getEntries(uint64_t bin) const;
+
+    // Multiply every weight filled so far by factor (sums of weights by
+    // factor, sums of squared weights by factor^2); entries are unchanged.
+    void scale(double factor);
+
+    // Add the contents of another accumulator with the same number of bins.
+    void merge(const BinAccumulator& other);
+
+    uint64_t size() const { return nBins_; }
+    bool isDense() const { return dense_; }
+    // Bytes currently allocated for the bin contents.
+    size_t memoryBytes() const;
+
+    // Calls f(bin, sumOfWeights, sumOfSquaredWeights, entries) for every
+    // bin that has been filled, in increasing bin order for dense storage.
+    template <class F>
+    void forEachFilled(F f) const {
+        if (dense_) {
+            for (uint64_t bin = 0; bin < nBins_; ++bin) {
+                if (entries_[bin] != 0 || values_[bin] != 0.0 || sumw2_[bin] != 0.0) {
+                    f(bin, values_[bin], sumw2_[bin], entries_[bin]);
+                }
+            }
+        } else {
+            for (size_t slot = 0; slot < keys_.size(); ++slot) {
+                if (keys_[slot] != 0) f(keys_[slot] - 1, values_[slot], sumw2_[slot], entries_[slot]);
+            }
+        }
+    }
+
+private:
+    uint64_t nBins_;
+    bool dense_;
+
+    // Dense mode: values_[bin]. Sparse mode: keys_[slot] holds bin + 1
+    // (0 marks an empty slot) and values_[slot] the matching sum. sumw2_ and
+    // entries_ are laid out like values_.
+    std::vector<double> values_;
+    std::vector<double> sumw2_;
+    std::vector<uint64_t> entries_;
+    std::vector<uint64_t> keys_;
+    size_t used_;
+    unsigned shift_;
+
+    size_t sparseSlot(uint64_t bin);
+    size_t findSlot(uint64_t key) const;
+    void rehash(size_t capacity);
+};
+
+#endif // BINACCUMULATOR_H
@@ -3,17 +3,32 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
+#include <cstdint>
 #include <regex>
+#include "BinAccumulator.h"
+#include "Expression.h"
 
 class BinningScheme {
 public:
+    // How the edges of a dimension are spaced. Uniform and log-uniform edges
+    // are looked up arithmetically in O(1); irregular edges use a binary search.
+    enum class EdgeSpacing { Uniform, LogUniform, Irregular };
+
     // Each dimension corresponds to one entry in the YAML "dimensions" list.
     struct Dimension {
         std::string name;
         std::string branch_true;
         std::string branch_reco;
         std::vector<double> edges;
+
+        // branch_reco parsed as an expression over the kinematics fields
+        // (e.g. "log10(Q2)" or "Mh/sqrt(Q2)"; see Expression).
+        Expression reco;
+
+        // Edge lookup, precomputed when the scheme is loaded.
+        EdgeSpacing spacing = EdgeSpacing::Irregular;
+        double lookupOrigin = 0.0; // first edge (or its log)
+        double lookupScale = 0.0;  // bins per unit (or per unit of log)
     };
 
     // Constructor: reads a YAML file and parses the binning scheme.
@@ -27,33 +42,87 @@ public:
     // For each dimension, if the value is out of [edge0, last_edge) range, returns -1.
     std::vector<int> findBins(const std::vector<double>& values) const;
 
+    // Given one value per dimension, returns the row-major linear bin index
+    // (last dimension varying fastest), or -1 if any value is out of range.
+    long long findLinearBin(const double* values) const;
+
+    // True if value lies within [edge0, last_edge) of the given dimension.
+    bool isInRange(size_t dim, double value) const;
+
     // Add an event to the internal bin counts.
-    // This method finds the appropriate bin (via findBins) and adds the given eventWeight.
-    // If any value is out of range (i.e. a bin index is -1), the event is skipped.
-    void addEvent(const std::vector<double>& values, double eventWeight);
+    // This method finds the appropriate bin and adds the given eventWeight.
+    // If any value is out of range, the event is skipped and false is returned.
+    bool addEvent(const std::vector<double>& values, double eventWeight);
+    // Same, for a caller-owned array holding one value per dimension.
+    bool addEvent(const double* values, double eventWeight);
+
+    // Reset all bin counts to zero.
+    void clear();
+
+    // Contents of one linear bin: sum of weights, sum of squared weights
+    // and number of entries.
+    double getSumW(uint64_t bin) const;
+    double getSumW2(uint64_t bin) const;
+    uint64_t getEntries(uint64_t bin) const;
+
+    // Multiply the weights of everything filled so far by factor (see
+    // BinAccumulator::scale).
+    void scale(double factor);
+
+    // Add the bin counts accumulated by another instance of the same scheme
+    // (e.g. a per-thread copy) into this one.
+    void merge(const BinningScheme& other);
 
     // Save the internal binned event counts to a CSV file.
     // The CSV file will have columns: for each dimension, two columns (e.g., Q2_min, Q2_max),
-    // followed by "scaled_events". The CSV will include all possible bins (even those with zero events).
+    // followed by "scaled_events", "sumw2" (sum of squared weights) and "entries" (number of
+    // entries). The CSV will include all possible bins (even those with zero events).
     void saveCSV(const std::string &outFilePath) const;
 
+    // Hash of the dimension names and edges. Accumulator states can only be
+    // combined between schemes with the same fingerprint.
+    uint64_t fingerprint() const;
+
+    // Save the accumulator state to a compact binary file: the scheme
+    // fingerprint followed by the filled bins with their sum of weights,
+    // sum of squared weights and entries. Values are stored exactly.
+    void saveState(const std::string &outFilePath) const;
+    // Add the bins of a state file written by saveState() for the same
+    // scheme. Throws std::runtime_error if the file is unreadable or was
+    // written with a different scheme.
+    void mergeState(const std::string &stateFilePath);
+
     // Utility: given a vector of bin indices, return a string key (e.g., "2_5").
     std::string makeBinKey(const std::vector<int>& bins) const;
 
     std::string getSchemeName() const;
 
     std::vector<std::string> getReconstructedBranches() const;
+    // The parsed branch_reco of each dimension.
+    std::vector<Expression> getReconstructedExpressions() const;
+
+    // Total number of bins (product of the bins in each dimension).
+    uint64_t getNumBins() const;
+    // Bytes currently allocated for the bin counts.
+    size_t getMemoryBytes() const;
     
 private:
     std::string pathToBinScheme; // yaml
     std::string energy_config;
     std::vector<Dimension> dimensions;
 
-    // Internal storage of binned event counts.
-    std::unordered_map<std::string, double> binCounts_;
+    // Row-major strides of each dimension in the linear bin index.
+    std::vector<uint64_t> strides_;
+
+    // Internal storage of binned event counts, indexed by linear bin.
+    BinAccumulator binCounts_;
 
     // Helper to load and parse the YAML file.
     void parseYAML(const std::string &yamlFilePath);
+    // Classify each dimension's edges and size the accumulator.
+    void prepareLookup();
+    // Bin index of val in the given dimension, or -1 if out of range.
+    static int findBin(const Dimension& dim, double val);
 };
 
 #endif // BINNINGSCHEME_H
@@ -0,0 +1,46 @@
+#ifndef BRANCHREADER_H
+#define BRANCHREADER_H
+
+#include <string>
+#include <vector>
+#include "Expression.h"
+#include "Kinematics.h"
+
+namespace eicQuickSim {
+
+/**
+ * Reads the binned quantities of a kinematics record (the scheme's
+ * branch_reco expressions, see Expression) into a caller-owned buffer, one
+ * value per branch. Variable names are matched case-insensitively to the
+ * record's members and resolved to offsets once, on construction, so read()
+ * does no string handling and no allocation. Variables a record type does
+ * not have read as 0.
+ */
+class BranchReader {
+public:
+    BranchReader() = default;
+    explicit BranchReader(const std::vector<Expression>& branches);
+    // Parses the branches first (throws std::runtime_error on a syntax error).
+    explicit BranchReader(const std::vector<std::string>& branches);
+
+    size_t size() const { return m_dis.size(); }
+
+    // Write size() values to out.
+    void read(const disKinematics& dis, double* out) const;
+    void read(const sidisKinematics& sid, double* out) const;
+    void read(const dihadronKinematics& dih, double* out) const;
+
+    // Member holding a branch, or nullptr if the record type has none.
+    static double disKinematics::*disMember(const std::string& branch);
+    static double sidisKinematics::*sidisMember(const std::string& branch);
+    static double dihadronKinematics::*dihadMember(const std::string& branch);
+
+private:
+    std::vector<Expression> m_dis;
+    std::vector<Expression> m_sidis;
+    std::vector<Expression> m_dihad;
+};
+
+} // namespace eicQuickSim
+
+#endif // BRANCHREADER_H
@@ -0,0 +1,138 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BinningScheme.h"
+
+namespace eicQuickSim {
+
+/**
+ * Periodic checkpoints of a running Analysis, so that a preempted job can be
+ * resumed instead of started over.
+ *
+ * A checkpoint is a small YAML progress file at the configured path plus a
+ * binned state (BinningScheme::saveState) next to it. The progress file
+ * records, for every input row, how many of its entries are done and whether
+ * it is complete, the number of tree entries that belong to the checkpoint
+ * and a fingerprint of the configuration. It is replaced atomically and is
+ * written last, so it always refers to a complete state file.
+ *
+ * Checkpoints are taken at event boundaries: once the event or time trigger
+ * fires, every worker stops after its current event, copies its accumulator
+ * in arrive() and carries on as soon as the last worker has arrived. Merging
+ * the copies and all file I/O happen on a background writer thread, so the
+ * event loop only pauses for about one event plus an in-memory copy.
+ */
+class Checkpoint {
+public:
+    // Per-row progress of a run, indexed like Analysis::m_combinedRows.
+    struct Progress {
+        uint64_t fingerprint = 0;
+        std::vector<long long> entriesDone;
+        std::vector<char> rowDone;
+        long long treeEntries = 0;
+    };
+
+    Checkpoint();
+    // Waits for a checkpoint that is still being written.
+    ~Checkpoint();
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    // Checkpoint to path every everyEvents events or everySeconds seconds,
+    // whichever comes first; 0 disables a trigger.
+    void configure(const std::string& path, long long everyEvents, double everySeconds);
+    bool enabled() const { return !m_path.empty(); }
+    const std::string& path() const { return m_path; }
+
+    // Read the checkpoint at path(). Returns false if there is none or it
+    // belongs to a different configuration (fingerprint), with a message.
+    // On success statePath is the binned state to merge into the scheme.
+    bool load(uint64_t fingerprint, Progress& progress, std::string& statePath);
+
+    // Start taking checkpoints for a run with nWorkers workers. base holds
+    // the bins restored from an earlier checkpoint (if any); collect()
+    // reports the run's progress and saveTree(n) makes the first n tree
+    // entries durable, n being the tree entries of that progress. Both are
+    // called with all workers paused (collect) or from the writer thread
+    // (saveTree).
+    void start(int nWorkers, const BinningScheme& base, uint64_t fingerprint,
+               std::function<Progress()> collect, std::function<void(long long)> saveTree);
+    // Wait for the last checkpoint to be written and stop the writer.
+    void stop();
+    // Delete the checkpoint files (after the outputs have been written).
+    void remove() const;
+
+    // Called by a worker after every event. Returns true when a checkpoint
+    // is pending; the worker must then call arrive(). localCount is a
+    // per-worker counter.
+    inline bool tick(long long& localCount) {
+        if(++localCount >= kTickBatch) {
+            countEvents(localCount);
+            localCount = 0;
+        }
+        return m_requested.load(std::memory_order_relaxed);
+    }
+    bool pending() const { return m_requested.load(std::memory_order_relaxed); }
+    // Hand in this worker's accumulator and wait for the other workers.
+    void arrive(const BinningScheme& workerScheme);
+    // Called by a worker that has run out of work, with its final
+    // accumulator, which later checkpoints include.
+    void leave(const BinningScheme& workerScheme);
+
+private:
+    static const long long kTickBatch = 64;
+
+    std::string m_path;
+    long long m_everyEvents;
+    double m_everySeconds;
+
+    uint64_t m_fingerprint;
+    std::unique_ptr<BinningScheme> m_base;
+    std::function<Progress()> m_collect;
+    std::function<void(long long)> m_saveTree;
+
+    // Trigger.
+    std::atomic<bool> m_requested;
+    std::atomic<long long> m_eventsSinceCheckpoint;
+    std::atomic<long long> m_lastCheckpointNs;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    // Barrier, guarded by m_mutex.
+    std::mutex m_mutex;
+    std::condition_variable m_barrierCond;
+    int m_active;
+    int m_arrived;
+    uint64_t m_generation;
+    std::vector<std::unique_ptr<BinningScheme>> m_snapshots;
+    std::vector<std::unique_ptr<BinningScheme>> m_retired; // from leave()
+    size_t m_snapshotRetired; // retired workers covered by the pending snapshot
+    Progress m_snapshotProgress;
+
+    // Background writer, guarded by m_mutex.
+    std::condition_variable m_writerCond;
+    std::thread m_writer;
+    bool m_writerBusy; // a snapshot is waiting or being written
+    bool m_stopWriter;
+    int m_stateSlot;   // state files alternate so the committed one survives
+
+    void countEvents(long long n);
+    void release();
+    void writerLoop();
+    void write(std::vector<std::unique_ptr<BinningScheme>>& snapshots,
+               const std::vector<const BinningScheme*>& retired, const Progress& progress);
+    std::string statePath(int slot) const;
+};
+
+} // namespace eicQuickSim
+
+#endif // CHECKPOINT_H
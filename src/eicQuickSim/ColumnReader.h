@@ -0,0 +1,80 @@
+#ifndef COLUMNREADER_H
+#define COLUMNREADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ParticleIndex.h"
+
+class TFile;
+class TTree;
+namespace HepMC3 { struct GenEventData; }
+
+namespace eicQuickSim {
+
+/**
+ * Reads the particle status, pid and four-momentum of the events in a HepMC3
+ * ROOT tree file (as written by HepMC3::WriterRootTree) without building
+ * GenEvents.
+ *
+ * WriterRootTree stores each event as a split GenEventData, so every member
+ * of the particle record is a branch of its own. All other branches
+ * (vertices, links, weights, attributes) are disabled: they are neither
+ * decompressed nor deserialised, and no particle/vertex graph is built.
+ * Events are read in batches into flat columns, from which a ParticleIndex
+ * is filled directly.
+ *
+ * Files without these branches (other writers, unsplit trees) leave the
+ * reader failed(); use HepMC3::ReaderRootTree for them, and wherever the
+ * full event record is needed.
+ */
+class ColumnReader {
+public:
+    // Particle columns of consecutive events: the particles of event i are
+    // the entries [offsets[i], offsets[i + 1]) of the other columns.
+    struct Batch {
+        std::vector<size_t> offsets;
+        std::vector<int> status;
+        std::vector<int> pid;
+        std::vector<double> px, py, pz, e;
+
+        size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+        // Keeps the capacity, so a reused batch does not reallocate.
+        void clear();
+        // Rebuild index from the particles of event i.
+        void fillIndex(size_t i, ParticleIndex& index) const;
+    };
+
+    explicit ColumnReader(const std::string& path);
+    ~ColumnReader();
+    ColumnReader(const ColumnReader&) = delete;
+    ColumnReader& operator=(const ColumnReader&) = delete;
+
+    // True if the file could not be opened, lacks the particle branches, or
+    // an entry could not be read.
+    bool failed() const { return !m_error.empty(); }
+    const std::string& error() const { return m_error; }
+
+    long long entries() const { return m_entries; }
+
+    // Read the entries [first, last) from now on (the read-ahead cache is
+    // limited to them). The default is the whole file.
+    void setRange(long long first, long long last);
+
+    // Read up to maxEvents events into batch (cleared first). Returns the
+    // number read: 0 at the end of the range or after a read error.
+    size_t readBatch(size_t maxEvents, Batch& batch);
+
+private:
+    TFile* m_file;
+    TTree* m_tree;
+    HepMC3::GenEventData* m_data;
+    long long m_entries;
+    long long m_next;
+    long long m_last;
+    std::string m_error;
+};
+
+} // namespace eicQuickSim
+
+#endif // COLUMNREADER_H
@@ -20,6 +20,19 @@ public:
                                                int numFiles,
                                                int maxEvents,
                                                const std::string& collisionType);
+
+    /**
+     * Preprocessing step of an HPC project: combines the rows as above,
+     * weights them with the luminosity CSV of the collision type and writes
+     * them with their weights to outputPath.
+     *
+     * @return false (after printing the reason) if nothing could be written.
+     */
+    static bool exportWeightedRows(const std::string& energyConfig,
+                                   int numFiles,
+                                   int maxEvents,
+                                   const std::string& collisionType,
+                                   const std::string& outputPath);
 };
 
 #endif // COMBINED_ROWSPROCESSOR_H
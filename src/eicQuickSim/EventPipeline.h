@@ -0,0 +1,138 @@
+#ifndef EVENTPIPELINE_H
+#define EVENTPIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HepMC3/GenEvent.h"
+
+namespace eicQuickSim {
+
+/**
+ * Read-ahead stage between the HepMC3 input files and the compute loop.
+ *
+ * A set of I/O threads opens the input files in order, ahead of the compute
+ * stage, and decodes their events into a bounded pool of reusable GenEvent
+ * slots (one pool per I/O thread, so at most prefetchFiles files are open at
+ * once and at most prefetchFiles * queueSize events are held in memory).
+ *
+ * Consumers claim files in the same order with claimFile() and pull that
+ * file's events with nextEvent(), handing every slot back with release().
+ * Events of one file are delivered in file order to the consumer that
+ * claimed it, so per-file bookkeeping works as with a plain reader.
+ */
+class EventPipeline {
+public:
+    // One decoded event. Owned by the pipeline; hand it back with release().
+    struct Slot {
+        HepMC3::GenEvent event;
+    private:
+        friend class EventPipeline;
+        size_t reader = 0;
+    };
+
+    struct Stats {
+        double computeWaitSeconds; // time consumers spent blocked in nextEvent()
+        double readerWaitSeconds;  // time I/O threads spent waiting for a free slot
+        double openSeconds;        // time spent opening files (summed over I/O threads)
+        uint64_t events;           // events decoded
+        uint64_t files;            // files opened successfully
+        uint64_t failedFiles;      // files that could not be opened
+    };
+
+    // Entry range [first, last) of one input to read.
+    struct Range {
+        long long first;
+        long long last;
+    };
+
+    // Maps an input path to the path actually opened (e.g. a local copy).
+    using Resolver = std::function<std::string(const std::string&)>;
+
+    // files: input paths, read in order. maxEvents: events read per file.
+    // prefetchFiles: number of I/O threads (files read concurrently).
+    // queueSize: event slots per I/O thread.
+    // ranges: optional entry range per file (shards); when empty every file
+    // is read from entry 0 up to maxEvents.
+    // resolve: optional; called by the I/O threads before opening a file,
+    // its time counted as open time.
+    EventPipeline(const std::vector<std::string>& files, int maxEvents,
+                  int prefetchFiles, size_t queueSize,
+                  const std::vector<Range>& ranges = {},
+                  const Resolver& resolve = Resolver());
+    // Stops the I/O threads (abandoning unread events) and joins them.
+    ~EventPipeline();
+    EventPipeline(const EventPipeline&) = delete;
+    EventPipeline& operator=(const EventPipeline&) = delete;
+
+    // Claim the next file, in order. Returns its index, or -1 once all files
+    // have been claimed. Thread-safe.
+    long long claimFile();
+
+    // Next event of a claimed file, blocking until it is decoded. Returns
+    // nullptr at the end of the file (or if it could not be opened).
+    Slot* nextEvent(size_t file);
+    // Same, but waits at most timeout; returns nullptr with timedOut set if
+    // no event arrived in time.
+    Slot* nextEvent(size_t file, std::chrono::milliseconds timeout, bool& timedOut);
+    // Return a slot to its I/O thread for reuse.
+    void release(Slot* slot);
+
+    // True if the file could not be opened; valid once nextEvent() has
+    // returned nullptr for it.
+    bool fileFailed(size_t file) const;
+
+    Stats stats() const;
+
+private:
+    // Decoded events of one file, waiting for its consumer.
+    struct FileQueue {
+        std::deque<Slot*> ready;
+        bool done = false;
+        bool failed = false;
+    };
+
+    // Pool of reusable slots owned by one I/O thread.
+    struct SlotPool {
+        std::vector<std::unique_ptr<Slot>> slots;
+        std::vector<Slot*> free;
+    };
+
+    std::vector<std::string> m_files;
+    std::vector<Range> m_ranges;
+    Resolver m_resolve;
+
+    std::vector<FileQueue> m_queues;
+    std::vector<SlotPool> m_pools;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_readyCond; // an event or end of file was queued
+    std::condition_variable m_freeCond;  // a slot was released
+    bool m_stop;
+
+    std::atomic<size_t> m_nextOpen;
+    std::atomic<size_t> m_nextClaim;
+    std::vector<std::thread> m_readers;
+
+    // Stats, in nanoseconds where applicable.
+    std::atomic<long long> m_computeWaitNs;
+    std::atomic<long long> m_readerWaitNs;
+    std::atomic<long long> m_openNs;
+    std::atomic<uint64_t> m_events;
+    std::atomic<uint64_t> m_openedFiles;
+    std::atomic<uint64_t> m_failedFiles;
+
+    void readerLoop(size_t reader);
+    void readFile(size_t file, size_t reader);
+};
+
+} // namespace eicQuickSim
+
+#endif // EVENTPIPELINE_H
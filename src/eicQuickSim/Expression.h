@@ -0,0 +1,67 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * An arithmetic expression over named variables, as used for a binning
+ * dimension's branch_reco (e.g. "Q2", "log10(Q2)", "Mh/sqrt(Q2)", "z1-z2").
+ *
+ * The text is parsed once into flat stack bytecode; constant subexpressions
+ * are folded. Supported are numbers, variables (identifiers), + - * / ^
+ * (right-associative power), unary minus, parentheses and the functions
+ * abs, sqrt, exp, log, log10, sin, cos, tan, asin, acos, atan (one argument)
+ * and atan2, pow, min, max (two arguments). Function names are
+ * case-insensitive.
+ *
+ * Variables are read from a record in memory: bind() assigns each variable
+ * a byte offset at which evaluate() loads it as a double. Unbound, variable
+ * i reads element i of a double array. Evaluation does no allocation.
+ */
+class Expression {
+public:
+    // Maximum stack depth an expression may need.
+    static const size_t kMaxStack = 32;
+
+    Expression() = default;
+    // Parse text; throws std::runtime_error describing the first syntax error.
+    explicit Expression(const std::string& text);
+
+    const std::string& text() const { return text_; }
+    // Variable names, in order of first appearance, as written.
+    const std::vector<std::string>& variables() const { return variables_; }
+    // True if the expression is a single variable.
+    bool isVariable() const;
+
+    // Copy whose variable i is read at byte offset offsets[i] of the record;
+    // a negative offset makes the variable read as 0.
+    Expression bind(const std::vector<std::ptrdiff_t>& offsets) const;
+
+    double evaluate(const void* record) const;
+
+private:
+    enum class Op : uint8_t {
+        Const, Load, Neg, Add, Sub, Mul, Div, Pow,
+        Abs, Sqrt, Exp, Log, Log10, Sin, Cos, Tan, Asin, Acos, Atan,
+        Atan2, Min, Max
+    };
+    struct Instruction {
+        Op op;
+        uint32_t var;         // Load: variable index
+        std::ptrdiff_t offset; // Load: byte offset in the record
+        double value;         // Const
+    };
+
+    std::string text_;
+    std::vector<std::string> variables_;
+    std::vector<Instruction> code_;
+
+    class Parser;
+    static int arity(Op op);
+    static double apply(Op op, double a, double b);
+};
+
+#endif // EXPRESSION_H
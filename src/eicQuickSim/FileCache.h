@@ -0,0 +1,66 @@
+#ifndef FILECACHE_H
+#define FILECACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace eicQuickSim {
+
+/**
+ * Node-local read-through cache of input files (typically root:// URLs),
+ * shared by all jobs on the node that use the same directory.
+ *
+ * fetch() returns the path of a local copy of the source. A copy is valid
+ * for the source's current size and modification time, which are part of
+ * its file name, so a changed source is simply a miss; the stale copy ages
+ * out. Copies are downloaded to a temporary name and renamed into place,
+ * which is atomic: concurrent jobs never see a partial file, and two jobs
+ * fetching the same source at once both end up with a complete copy.
+ *
+ * The directory is kept below maxBytes by deleting the least recently used
+ * copies (the modification time of a copy is bumped on every hit). A
+ * deleted copy that another job already opened stays readable for it.
+ * Sources larger than maxBytes, or that cannot be copied, are returned
+ * unchanged.
+ */
+class FileCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;       // copied into the cache
+        uint64_t uncached = 0;     // returned unchanged (too large, unreachable, copy failed)
+        uint64_t evicted = 0;
+        uint64_t bytesSaved = 0;   // bytes of the sources served from the cache
+        uint64_t bytesFetched = 0; // bytes copied into the cache
+    };
+
+    // Creates dir if needed; throws std::runtime_error if that fails.
+    FileCache(const std::string& dir, uint64_t maxBytes);
+
+    // Local path to read source from: the cached copy, or source itself if
+    // it cannot be cached. Thread-safe.
+    std::string fetch(const std::string& source);
+
+    // True for URLs of a remote protocol (root://, http://, ...), the
+    // inputs worth caching.
+    static bool isRemote(const std::string& path);
+
+    Stats stats() const;
+    const std::string& directory() const { return m_dir; }
+    uint64_t maxBytes() const { return m_maxBytes; }
+
+private:
+    std::string m_dir;
+    uint64_t m_maxBytes;
+    Stats m_stats;
+    mutable std::mutex m_mutex;
+
+    // Delete least recently used copies until the cache fits in maxBytes,
+    // never deleting keep. Also drops temporary files of crashed jobs.
+    void evict(const std::string& keep);
+};
+
+} // namespace eicQuickSim
+
+#endif // FILECACHE_H
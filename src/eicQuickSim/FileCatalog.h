@@ -0,0 +1,105 @@
+#ifndef FILECATALOG_H
+#define FILECATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FileManager.h"
+
+/**
+ * Compiled, memory-mapped form of a file CSV (".qcat").
+ *
+ * Layout (native byte order, every section 8-byte aligned):
+ *   QcatHeader
+ *   QcatGroup[nGroups]  one per (e, h, Q2 range), in order of first appearance
+ *   QcatRow[nRows]      rows grouped, in CSV order within each group
+ *   char[stringBytes]   filenames, each stored once
+ *
+ * Each group carries its totals (events, cross section, provided weight), so
+ * group queries and weight derivation cost O(groups) instead of O(rows), and
+ * a row is only turned into a CSVRow when it is requested. The header records
+ * the size and modification time of the source CSV so that FileManager can
+ * tell whether a catalog next to a CSV is still current.
+ */
+struct QcatHeader {
+    char     magic[8];      // "EICQCAT\0"
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t nGroups;
+    uint64_t nRows;
+    uint64_t stringBytes;
+    uint64_t sourceSize;    // size of the CSV the catalog was built from
+    int64_t  sourceMtime;   // its modification time (seconds since the epoch)
+    uint64_t reserved;
+};
+
+struct QcatGroup {
+    int32_t  eEnergy;
+    int32_t  hEnergy;
+    int32_t  q2Min;
+    int32_t  q2Max;
+    uint64_t firstRow;       // index of the group's first QcatRow
+    uint64_t nRows;
+    int64_t  events;         // sum of FileManager::eventCount over the rows
+    int64_t  maxRowEvents;   // largest nEvents of any row
+    double   crossSectionPb; // cross section of the last row (as Weights uses it)
+    double   weight;         // first provided weight (>= 0), or -1
+};
+
+struct QcatRow {
+    uint64_t nameOffset;
+    uint32_t nameLength;
+    int32_t  nEvents;
+    double   crossSectionPb;
+    double   weight;
+    int64_t  firstEntry;
+    int64_t  nEntries;
+};
+
+class FileCatalog {
+public:
+    /**
+     * Map a catalog written by write(). Throws std::runtime_error if the file
+     * cannot be opened or is not a valid catalog.
+     */
+    explicit FileCatalog(const std::string &qcatPath);
+    ~FileCatalog();
+
+    FileCatalog(const FileCatalog &) = delete;
+    FileCatalog &operator=(const FileCatalog &) = delete;
+
+    /**
+     * Write the catalog of rows to qcatPath (via a temporary file and a
+     * rename). sourceSize/sourceMtime identify the CSV the rows came from.
+     */
+    static void write(const std::vector<CSVRow> &rows, const std::string &qcatPath,
+                      uint64_t sourceSize = 0, int64_t sourceMtime = 0);
+
+    size_t numGroups() const { return static_cast<size_t>(header_->nGroups); }
+    size_t numRows() const { return static_cast<size_t>(header_->nRows); }
+    uint64_t sourceSize() const { return header_->sourceSize; }
+    int64_t sourceMtime() const { return header_->sourceMtime; }
+
+    const QcatGroup &group(size_t i) const { return groups_[i]; }
+
+    // Group for (e, h, q2Min, q2Max), or nullptr.
+    const QcatGroup *findGroup(int eEnergy, int hEnergy, int q2Min, int q2Max) const;
+
+    // Row i (0-based) of group g, as a CSVRow.
+    CSVRow row(const QcatGroup &g, size_t i) const;
+
+    // Filename of row i of group g, without building the CSVRow.
+    std::string filename(const QcatGroup &g, size_t i) const;
+
+private:
+    void *data_ = nullptr;
+    size_t size_ = 0;
+    const QcatHeader *header_ = nullptr;
+    const QcatGroup *groups_ = nullptr;
+    const QcatRow *rows_ = nullptr;
+    const char *strings_ = nullptr;
+};
+
+#endif // FILECATALOG_H
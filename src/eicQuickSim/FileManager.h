@@ -1,10 +1,13 @@
 #ifndef FILEMANAGER_H
 #define FILEMANAGER_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
+class FileCatalog;
+
 /**
  * Holds the information from each CSV row:
  *  - filename          e.g. root://dtn-eic.jlab.org//some/path.root
@@ -13,6 +16,12 @@
  *  - nEvents           how many events in that file
  *  - crossSectionPb    cross section in pb
  *  - weight            scaling weight
+ *  - firstEntry        first event (tree entry) of this work unit
+ *  - nEntries          number of events in this work unit, or -1 for
+ *                      "up to the end of the file"
+ *
+ * A row with firstEntry/nEntries set is a shard: one slice of a file that
+ * has been split into several work units.
  */
 struct CSVRow {
     std::string filename;
@@ -23,6 +32,8 @@ struct CSVRow {
     int         nEvents;
     double      crossSectionPb;
     double      weight = -1.0;
+    long long   firstEntry = 0;
+    long long   nEntries = -1;
 };
 
 /**
@@ -62,6 +73,22 @@ struct EnergyQ2KeyHash {
     }
 };
 
+/**
+ * Totals of one (e, h, q2Min, q2Max) group of rows, as Weights needs them:
+ * the number of events (FileManager::eventCount summed over the rows), the
+ * cross section of the last row and the first provided weight (-1 if none).
+ */
+struct CSVGroupSummary {
+    int       eEnergy;
+    int       hEnergy;
+    int       q2Min;
+    int       q2Max;
+    int       nRows;
+    long long events;
+    double    crossSectionPb;
+    double    weight;
+};
+
 /**
  * The FileManager class now reads a CSV file (e.g. summary.csv),
  * and provides a getFiles(...) method to retrieve up to N filenames
@@ -72,6 +99,10 @@ public:
     /**
      * @param csvPath Path to a CSV file containing lines of:
      *        filename,q2Min,q2Max,eEnergy,hEnergy,nEvents,crossSectionPb
+     *        optionally followed by weight, first_entry and n_entries.
+     *        A compiled catalog (".qcat", see FileCatalog.h) may be given
+     *        instead; one next to the CSV (catalogPathFor) is used in place
+     *        of the CSV as long as it was built from the current CSV.
      */
     FileManager(const std::string &csvPath);
 
@@ -96,21 +127,89 @@ public:
     */
     std::vector<CSVRow> getAllCSVData(int nRowsRequested, int maxEvents) const;
     
+    /**
+     * Totals of every group, in order of first appearance, over the rows
+     * getCSVData(..., nRowsRequested, maxEvents) would return. With a catalog
+     * and no row or event cap this reads the stored totals: O(groups).
+     */
+    std::vector<CSVGroupSummary> getGroupSummaries(int nRowsRequested = -1, int maxEvents = -1) const;
+
+    /**
+     * True if the rows are read from a compiled catalog.
+     */
+    bool usesCatalog() const { return static_cast<bool>(catalog_); }
+
+    /**
+     * Group totals of an arbitrary set of rows, in order of first appearance.
+     */
+    static std::vector<CSVGroupSummary> summarizeRows(const std::vector<CSVRow> &rows);
+
+    /**
+     * Catalog path used for a CSV: the CSV path with ".qcat" as extension.
+     */
+    static std::string catalogPathFor(const std::string &csvPath);
+
+    /**
+     * Parse csvPath and write its compiled catalog to qcatPath.
+     * Throws std::runtime_error on failure.
+     */
+    static void buildCatalog(const std::string &csvPath, const std::string &qcatPath);
+
     /**
      * Combine any number of CSVData vectors into one.
     */
     static std::vector<CSVRow> combineCSV(const std::vector<std::vector<CSVRow>> &dataSets);
 
+    /**
+     * Number of events a row contributes: its shard size, or for a whole
+     * file nEvents. Shards of one file add up to the file's nEvents.
+     */
+    static long long eventCount(const CSVRow &row);
+
+    /**
+     * Entry range [first, last) to read for a row, given the per-file event
+     * cap maxEvents (entries at or beyond maxEvents are never read).
+     */
+    static void entryRange(const CSVRow &row, int maxEvents, long long &first, long long &last);
+
+    /**
+     * Split every row holding more than eventsPerShard events into shards of
+     * at most eventsPerShard events each. Rows that are already shards are
+     * split further within their own range.
+     */
+    static std::vector<CSVRow> shardRows(const std::vector<CSVRow> &rows, long long eventsPerShard);
+
+    /**
+     * Read every valid row of a CSV file, in file order.
+     */
+    static bool readCSV(const std::string &csvPath, std::vector<CSVRow> &rows);
+
+    /**
+     * Write rows to a CSV file that readCSV reads back unchanged, including
+     * the weight and shard columns. Throws std::runtime_error on failure.
+     */
+    static void writeCSV(const std::string &csvPath, const std::vector<CSVRow> &rows);
+
 private:
     /**
      * Internal map: (e, h, q2Min, q2Max) -> all CSVRows for that group
      */
     std::unordered_map<EnergyQ2Key, std::vector<CSVRow>, EnergyQ2KeyHash> csvMap_;
 
+    /**
+     * Keys of csvMap_ in order of first appearance in the CSV.
+     */
+    std::vector<EnergyQ2Key> groupOrder_;
+
+    /**
+     * Compiled catalog, if the rows come from one (csvMap_ is then empty).
+     */
+    std::shared_ptr<const FileCatalog> catalog_;
+
     /**
      * Helper function to parse a single CSV line and produce a CSVRow.
      */
-    CSVRow parseLine(const std::string &line) const;
+    static CSVRow parseLine(const std::string &line);
 };
 
 #endif // FILEMANAGER_H
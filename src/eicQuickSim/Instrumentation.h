@@ -0,0 +1,105 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Hot-path instrumentation of the event loop. Configure with
+// -DEIC_INSTRUMENTATION=OFF to compile every timer and counter out; the run
+// report is then written without stage timings.
+#ifndef EIC_INSTRUMENTATION
+#define EIC_INSTRUMENTATION 1
+#endif
+
+namespace eicQuickSim {
+
+// Stages of the event loop timed in the run report.
+enum class Stage {
+    OpenFile,         // opening an input file and seeking to its first entry
+    ReadEvent,        // read_event, or waiting for the input pipeline
+    BuildIndex,       // ParticleIndex::build
+    DISKinematics,    // Kinematics::computeDIS
+    HadronKinematics, // Kinematics::computeSIDIS / computeDISIDS
+    Weight,           // Weights::getWeight
+    Binning,          // value functions and BinningScheme::addEvent
+    TreeFill,         // handing rows to the TreeManager
+    Count
+};
+const char* stageName(Stage stage);
+
+// Counters of one input file.
+struct FileStats {
+    std::string filename;
+    double seconds = 0.0;
+    long long events = 0;
+    long long entries = 0;  // SIDIS hadrons or DISIDIS pairs (events for DIS)
+    long long rejected = 0; // entries outside the binning
+};
+
+// Timers and counters of one worker thread, merged into one at the end of
+// a run. Not thread-safe: every worker owns its own.
+struct RunStats {
+    int64_t stageNs[static_cast<int>(Stage::Count)] = {};
+    long long stageCalls[static_cast<int>(Stage::Count)] = {};
+    long long events = 0;
+    long long entries = 0;
+    long long rejected = 0;
+    std::vector<FileStats> files;
+
+    void add(Stage stage, int64_t ns) {
+        stageNs[static_cast<int>(stage)] += ns;
+        ++stageCalls[static_cast<int>(stage)];
+    }
+    void merge(const RunStats& other);
+};
+
+inline int64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Adds the lifetime of the scope to a stage.
+class ScopedTimer {
+public:
+    ScopedTimer(RunStats& stats, Stage stage)
+        : m_stats(stats), m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { m_stats.add(m_stage, elapsedNs(m_start)); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    RunStats& m_stats;
+    Stage m_stage;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Peak resident set size of the process in kB.
+long peakRSSKB();
+
+// Write the run report as JSON. info holds descriptive string fields
+// (analysis type, energy configuration, ...), extra additional numbers
+// (e.g. input pipeline statistics); non-finite numbers are written as null.
+// Throws std::runtime_error on failure.
+void writeRunReport(const std::string& path, const RunStats& stats, double wallSeconds, int nThreads,
+                    long long bytesRead, const std::map<std::string, std::string>& info,
+                    const std::map<std::string, double>& extra);
+
+} // namespace eicQuickSim
+
+#define EIC_INSTR_CONCAT_(a, b) a##b
+#define EIC_INSTR_CONCAT(a, b) EIC_INSTR_CONCAT_(a, b)
+
+#if EIC_INSTRUMENTATION
+// Time the rest of the enclosing scope as the given Stage.
+#define EIC_TIME_SCOPE(stats, stage) \
+    ::eicQuickSim::ScopedTimer EIC_INSTR_CONCAT(eicScopedTimer_, __LINE__)((stats), ::eicQuickSim::Stage::stage)
+// A statement that only exists in instrumented builds, e.g. a counter.
+#define EIC_STAT(statement) statement
+#else
+#define EIC_TIME_SCOPE(stats, stage) ((void)0)
+#define EIC_STAT(statement) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_H
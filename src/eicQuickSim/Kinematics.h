@@ -3,8 +3,11 @@
 
 #include "HepMC3/GenEvent.h"
 #include "TLorentzVector.h"
+#include "ParticleIndex.h"
+#include "Vec4.h"
 #include <vector>
 #include <memory>
+#include <limits>
 
 namespace eicQuickSim {
 
@@ -57,9 +60,65 @@ struct dihadronKinematics {
 
 class Kinematics {
 public:
+    // Hadron-level quantities that computeSIDIS/computeDISIDS can be asked to
+    // evaluate, as bit flags. The DIS variables (Q2, x, y, W) are always
+    // computed; fields that are not requested are left at 0.
+    enum Field : unsigned {
+        FieldXF        = 1u << 0,  // xF (SIDIS), xF1/xF2 (dihadron)
+        FieldEta       = 1u << 1,
+        FieldZ         = 1u << 2,  // z (SIDIS), z1/z2 (dihadron)
+        FieldPhi       = 1u << 3,
+        FieldPTLab     = 1u << 4,  // pT_lab (SIDIS), pT_lab_1/2 (dihadron)
+        FieldPTCom     = 1u << 5,  // pT_com (SIDIS), pT_com_1/2 (dihadron)
+        FieldZPair     = 1u << 6,
+        FieldPhiH      = 1u << 7,
+        FieldPhiR0     = 1u << 8,
+        FieldPhiR1     = 1u << 9,
+        FieldPTLabPair = 1u << 10,
+        FieldPTComPair = 1u << 11,
+        FieldXFPair    = 1u << 12,
+        FieldComTh     = 1u << 13,
+        FieldMh        = 1u << 14,
+        AllFields      = 0xFFFFFFFFu
+    };
+
+    // Version of the kinematics definitions. Bump it whenever a computed
+    // quantity changes meaning, so that stored results (KinematicsCache)
+    // made with the old definitions are rebuilt.
+    static const unsigned kVersion = 1;
+
     Kinematics();
 
+    // Half-open windows [min, max) on z_pair and Mh. computeDISIDS drops
+    // pairs outside them before evaluating the remaining pair quantities
+    // (phi_R, com_th, ...). The default accepts every pair.
+    struct PairSelection {
+        double zPairMin = -std::numeric_limits<double>::infinity();
+        double zPairMax = std::numeric_limits<double>::infinity();
+        double mhMin = -std::numeric_limits<double>::infinity();
+        double mhMax = std::numeric_limits<double>::infinity();
+
+        bool active() const {
+            return zPairMin != -std::numeric_limits<double>::infinity() ||
+                   zPairMax != std::numeric_limits<double>::infinity() ||
+                   mhMin != -std::numeric_limits<double>::infinity() ||
+                   mhMax != std::numeric_limits<double>::infinity();
+        }
+    };
+
+    // Restrict the hadron-level computations to the given Field flags
+    // (default: AllFields).
+    void setRequiredFields(unsigned fields) { requiredFields_ = fields; }
+    unsigned getRequiredFields() const { return requiredFields_; }
+
+    void setPairSelection(const PairSelection& selection) { pairSelection_ = selection; }
+    const PairSelection& getPairSelection() const { return pairSelection_; }
+
     // Compute and store DIS kinematics from a GenEvent.
+    // This indexes the event's particles once; computeSIDIS/computeDISIDS
+    // called afterwards with the same event reuse that index. Every
+    // computeDIS starts from cleared results, so one Kinematics object can
+    // be reused for all events; its buffers keep their capacity.
     void computeDIS(const HepMC3::GenEvent& evt);
 
     // Compute SIDIS kinematics for a given final state particle (identified by pid).
@@ -70,15 +129,26 @@ public:
     // Requires two PIDs; if they are identical, unique pairs are formed.
     void computeDISIDS(const HepMC3::GenEvent& evt, int pid1, int pid2);
 
-    // Getters for the stored kinematics.
-    disKinematics getDISKinematics() const;
-    std::vector<sidisKinematics> getSIDISKinematics() const;
-    std::vector<dihadronKinematics> getDISIDSKinematics() const;
+    // Same as above, from an already built particle index.
+    void computeDIS(const ParticleIndex& index);
+    void computeSIDIS(const ParticleIndex& index, int pid);
+    void computeDISIDS(const ParticleIndex& index, int pid1, int pid2);
+
+    // Clear the stored kinematics (done by computeDIS).
+    void clear();
+
+    // Views of the stored kinematics, valid until the next compute call.
+    const disKinematics& getDISKinematics() const { return disKin_; }
+    const std::vector<sidisKinematics>& getSIDISKinematics() const { return sidisKin_; }
+    const std::vector<dihadronKinematics>& getDISIDSKinematics() const { return dihadKin_; }
 
     // Helper functions.
     static TLorentzVector buildFourVector(const std::shared_ptr<const HepMC3::GenParticle>& particle);
     static std::vector<std::shared_ptr<const HepMC3::GenParticle>>
         searchParticle(const HepMC3::GenEvent& evt, int status, int pid);
+    // Same, into a caller-owned vector (cleared first).
+    static void searchParticle(const HepMC3::GenEvent& evt, int status, int pid,
+                               std::vector<std::shared_ptr<const HepMC3::GenParticle>>& found);
 
     // Calculate xF for a hadron.
     static double xF(const TLorentzVector& q, const TLorentzVector& h,
@@ -112,7 +182,68 @@ public:
     // Compute the invariant mass (Mh) of the pair.
     static double invariantMass(const TLorentzVector& P1, const TLorentzVector& P2);
 
+    // Overloads of the above on plain four-vectors. The TLorentzVector
+    // versions forward to these.
+    static double xF(const Vec4& q, const Vec4& h, const Vec4& pIn, double W);
+    static double eta(const Vec4& h);
+    static double z(const Vec4& q, const Vec4& h, const Vec4& pIn);
+    static double phi(const Vec4& q, const Vec4& h, const Vec4& eIn);
+    static double pT_lab(const Vec4& h);
+    static double pT_com(const Vec4& q, const Vec4& h, const Vec4& pIn);
+    static double phi_R(const Vec4& Q, const Vec4& L, const Vec4& p1, const Vec4& p2,
+                        const Vec4& init_target, int method);
+    static double com_th(const Vec4& P1, const Vec4& P2);
+    static double invariantMass(const Vec4& P1, const Vec4& P2);
+
+    static Vec4 toVec4(const TLorentzVector& v);
+
 private:
+    unsigned requiredFields_;
+    PairSelection pairSelection_;
+
+    // Momenta and single-hadron quantities (restricted to requiredFields_)
+    // of the hadrons of one pid, as parallel arrays.
+    struct HadronColumns {
+        std::vector<double> px, py, pz, e;
+        std::vector<double> z, pTLab, pTCom, xF;
+        void resize(size_t n);
+        Vec4 momentum(size_t i) const { return Vec4{px[i], py[i], pz[i], e[i]}; }
+    };
+    void fillHadrons(const ParticleIndex& index, ParticleIndex::Range particles, HadronColumns& hadrons) const;
+    // Add the pair (h1[i], h2[j]), whose z_pair and Mh are already known,
+    // restricted to requiredFields_.
+    void addPair(const HadronColumns& h1, size_t i, const HadronColumns& h2, size_t j,
+                 double zPair, double mh);
+
+    // Quantities of a hadron h, and of hh = h boosted into the gamma-N
+    // centre-of-mass frame, using the event-level terms below. They equal
+    // the static functions of the same name.
+    double zOf(const Vec4& h) const { return dot(pIn_, h) / pInDotQ_; }
+    double phiOf(const Vec4& h) const;
+    Vec4 toCom(const Vec4& h) const { return boost(h, -comBoost_); }
+    double xFOfCom(const Vec4& hh) const;
+    double pTComOfCom(const Vec4& hh) const { return perp(hh.vect(), qCom_.vect()); }
+
+    // Particle index of the event last passed to computeDIS(GenEvent).
+    ParticleIndex index_;
+    const HepMC3::GenEvent* indexedEvent_;
+    const ParticleIndex& indexFor(const HepMC3::GenEvent& evt);
+
+    // Plain copies of the event-level vectors used by the hadron loops, and
+    // the terms shared by all hadrons of the event: the gamma-N centre-of-mass
+    // boost and q in that frame, p.q and q x eIn.
+    Vec4 eIn_, eOut_, pIn_, q_;
+    Vec3 comBoost_;
+    Vec4 qCom_;
+    double qComMag_;
+    double pInDotQ_;
+    Vec3 qCrossL_;
+    double qCrossLMag_;
+
+    // Buffers of computeDISIDS, reused across events.
+    HadronColumns hadrons1_, hadrons2_;
+    std::vector<double> pairZ_, pairMh_;
+
     disKinematics disKin_;
     std::vector<sidisKinematics> sidisKin_;
     std::vector<dihadronKinematics> dihadKin_;
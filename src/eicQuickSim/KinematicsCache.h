@@ -0,0 +1,125 @@
+#ifndef KINEMATICSCACHE_H
+#define KINEMATICSCACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "FileManager.h"
+#include "Kinematics.h"
+
+namespace eicQuickSim {
+
+/**
+ * Local columnar store of computed kinematics, so a new binning scheme can be
+ * applied without re-reading and re-decoding the HepMC3 input.
+ *
+ * A cache holds the records of one analysis type (one disKinematics per
+ * event, one sidisKinematics per hadron or one dihadronKinematics per pair)
+ * together with the event weight. Records are grouped into one section per
+ * source CSV row; inside a section every quantity is stored as a contiguous
+ * column of doubles. The file is read back through mmap.
+ *
+ * Layout (host byte order):
+ *   header   64 bytes: magic, format version, Kinematics::kVersion,
+ *            fingerprint, analysis type, column count, section count and
+ *            offset of the section index
+ *   sections nColumns x nRecords doubles each
+ *   index    one {rowIndex, nEvents, nRecords, offset} entry per section
+ *
+ * The header is rewritten by finish(), so a build that did not complete
+ * leaves a file that open() rejects.
+ */
+class KinematicsCache {
+public:
+    // Records of one source file, filled by a single worker before being
+    // handed to writeSection().
+    class Section {
+    public:
+        void addDIS(const disKinematics& dis, double eventWeight);
+        void addSIDIS(const sidisKinematics& sid, double eventWeight);
+        void addDISIDIS(const dihadronKinematics& dih, double eventWeight);
+        size_t size() const;
+        void clear();
+
+    private:
+        friend class KinematicsCache;
+        std::vector<std::vector<double>> m_columns;
+    };
+
+    // Read-only view of one section of an open cache.
+    struct SectionInfo {
+        uint64_t rowIndex;  // index of the source row in the combined CSV rows
+        uint64_t nEvents;   // events read from that file
+        uint64_t nRecords;  // records (events, hadrons or pairs) stored
+        uint64_t offset;    // byte offset of the first column
+    };
+
+    KinematicsCache();
+    ~KinematicsCache();
+    KinematicsCache(const KinematicsCache&) = delete;
+    KinematicsCache& operator=(const KinematicsCache&) = delete;
+
+    // Hash identifying the inputs a cache was built from: the source rows,
+    // the analysis settings and the contents of the Q2 weights file.
+    static uint64_t fingerprint(const std::vector<CSVRow>& rows,
+                                const std::string& analysisType,
+                                int pid1, int pid2, int maxEvents,
+                                const std::string& weightsPath);
+
+    // --- Writing ---
+    // Create (truncate) the cache file. Throws std::runtime_error on failure.
+    void create(const std::string& path, const std::string& analysisType, uint64_t fingerprint);
+    // Append one section. Safe to call from several threads.
+    void writeSection(uint64_t rowIndex, uint64_t nEvents, const Section& section);
+    // Write the section index and the final header, and close the file.
+    void finish();
+    // Close the file without finishing it: open() keeps rejecting it as
+    // incomplete. For builds that missed some of their input.
+    void abandon();
+    bool isWriting() const { return m_out != nullptr; }
+
+    // --- Reading ---
+    // Map an existing cache. Returns false (with a message) if the file is
+    // missing, incomplete, or stale with respect to the given fingerprint,
+    // analysis type or the current Kinematics::kVersion.
+    bool open(const std::string& path, const std::string& analysisType, uint64_t fingerprint);
+    void close();
+    bool isOpen() const { return m_map != nullptr; }
+
+    size_t numSections() const { return m_index.size(); }
+    const SectionInfo& sectionInfo(size_t section) const { return m_index[section]; }
+    // Column c of a section (nRecords values).
+    const double* column(size_t section, size_t c) const;
+
+    // Rebuild record r of a section. Only the scalar quantities are stored;
+    // the four-vectors of disKinematics are left default-constructed.
+    void getDIS(size_t section, size_t r, disKinematics& dis, double& eventWeight) const;
+    void getSIDIS(size_t section, size_t r, sidisKinematics& sid, double& eventWeight) const;
+    void getDISIDIS(size_t section, size_t r, dihadronKinematics& dih, double& eventWeight) const;
+
+    // Number of columns stored for an analysis type, including the weight.
+    static size_t numColumns(const std::string& analysisType);
+
+private:
+    std::string m_path;
+    std::string m_analysisType;
+    size_t m_nColumns;
+
+    // Writing state.
+    FILE* m_out;
+    uint64_t m_fingerprint;
+    uint64_t m_writeOffset;
+    std::mutex m_writeMutex;
+
+    // Reading state.
+    void* m_map;
+    size_t m_mapSize;
+
+    std::vector<SectionInfo> m_index;
+};
+
+} // namespace eicQuickSim
+
+#endif // KINEMATICSCACHE_H
@@ -0,0 +1,86 @@
+#ifndef MULTIANALYSIS_H
+#define MULTIANALYSIS_H
+
+#include <string>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include "Analysis.h"
+
+namespace eicQuickSim {
+
+/**
+ * Runs several analyses (each with its own type, pids, binning scheme and
+ * outputs) over the same input files in a single pass. Every event is read
+ * and decoded once, its particles are indexed and its DIS kinematics are
+ * computed once, and the result is handed to each analysis in turn.
+ *
+ * YAML layout: the input keys (energy_config, csv_source, max_events,
+ * collision_type, n_threads, events_per_shard, column_input, file_cache,
+ * file_cache_size_gb) are shared; each entry of the "analyses" list
+ * holds the per-analysis keys of a regular Analysis YAML (analysis_type,
+ * binning_scheme, output_csv, optional output_tree and tree_options, sidis_pid or
+ * disidispid1/disidispid2).
+ *
+ * Files are read through Analysis' input path (file cache, column reader,
+ * failure counting, run report timers). Prefetching, checkpoints, the
+ * kinematics cache and precision targets are not available; run() warns and
+ * ignores them.
+ */
+class MultiAnalysis {
+public:
+    MultiAnalysis();
+    ~MultiAnalysis();
+
+    // Returns false if the YAML cannot be read (see Analysis::initFromYaml).
+    bool initFromYaml(const std::string& yamlFile);
+
+    // Shared input parameters, applied to every analysis.
+    void setEnergyConfig(const std::string& energyConfig);
+    void setCSVSource(const std::string& csvSource);
+    void setMaxEvents(int maxEvents);
+    void setCollisionType(const std::string& collisionType);
+    void setNumThreads(int nThreads);
+    void setEventsPerShard(long long eventsPerShard); // see Analysis::setEventsPerShard
+    void setColumnInput(bool columnInput);            // see Analysis::setColumnInput
+    void setFileCache(const std::string& dir, uint64_t maxBytes); // see Analysis::setFileCache
+
+    // Add an analysis. The shared inputs are applied when run() starts, so
+    // only its type, pids, binning scheme and outputs need to be set. The
+    // MultiAnalysis takes ownership.
+    Analysis* addAnalysis();
+
+    // Process all events once and feed every analysis, then save all outputs.
+    // run() returns false if it could not start; end() if an output of any
+    // analysis could not be written.
+    bool run();
+    bool end();
+
+    // Input files of the last run() that could not be opened or read completely.
+    int getFailedFiles() const { return m_failedFiles; }
+
+private:
+    std::string m_energyConfig;
+    std::string m_csvSource;
+    int m_maxEvents;
+    std::string m_collisionType;
+    int m_nThreads;
+    long long m_eventsPerShard;
+    bool m_columnInput;
+    std::string m_fileCacheDir;
+    uint64_t m_fileCacheBytes;
+    std::atomic<int> m_failedFiles;
+
+    std::vector<Analysis*> m_analyses;
+    std::vector<CSVRow> m_combinedRows;
+    std::mutex m_logMutex;
+
+    // Read one file and dispatch its events to every analysis, using the
+    // workers with index workerIndex. The particle index and kinematics of
+    // the first analysis' worker are shared by all of them.
+    void processFile(size_t rowIndex, size_t workerIndex);
+};
+
+} // namespace eicQuickSim
+
+#endif // MULTIANALYSIS_H
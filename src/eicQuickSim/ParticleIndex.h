@@ -0,0 +1,82 @@
+#ifndef PARTICLEINDEX_H
+#define PARTICLEINDEX_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "HepMC3/GenEvent.h"
+#include "Vec4.h"
+
+namespace eicQuickSim {
+
+/**
+ * Flat, per-event copy of the particle record: status, pid and four-momentum
+ * stored as parallel arrays, plus a lookup of particles by (status, pid).
+ *
+ * It is built in a single pass over a GenEvent (or filled directly from
+ * columns via add()/finalize()), after which the Kinematics computations no
+ * longer need to touch the HepMC3 objects. Buffers keep their capacity
+ * between events, so reusing one index does not reallocate.
+ */
+class ParticleIndex {
+public:
+    // Indices (into the particle arrays) of the particles matching one
+    // (status, pid) key, in event order.
+    class Range {
+    public:
+        Range(const int* first, const int* last) : first_(first), last_(last) {}
+        const int* begin() const { return first_; }
+        const int* end() const { return last_; }
+        size_t size() const { return static_cast<size_t>(last_ - first_); }
+        bool empty() const { return first_ == last_; }
+        int operator[](size_t i) const { return first_[i]; }
+    private:
+        const int* first_;
+        const int* last_;
+    };
+
+    // Rebuild the index from all particles in the event.
+    void build(const HepMC3::GenEvent& evt);
+
+    // Incremental filling: clear(), add() each particle, then finalize().
+    void clear();
+    void add(int status, int pid, double px, double py, double pz, double e);
+    void finalize();
+
+    size_t size() const { return m_status.size(); }
+
+    // All particles with the given status and pid, in event order.
+    Range find(int status, int pid) const;
+    // Index of the first such particle, or -1 if there is none.
+    int first(int status, int pid) const;
+
+    int status(int i) const { return m_status[i]; }
+    int pid(int i) const { return m_pid[i]; }
+    Vec4 momentum(int i) const { return Vec4{m_px[i], m_py[i], m_pz[i], m_e[i]}; }
+
+    const std::vector<double>& px() const { return m_px; }
+    const std::vector<double>& py() const { return m_py; }
+    const std::vector<double>& pz() const { return m_pz; }
+    const std::vector<double>& e() const { return m_e; }
+
+private:
+    // Particle record, one entry per particle.
+    std::vector<int> m_status;
+    std::vector<int> m_pid;
+    std::vector<double> m_px, m_py, m_pz, m_e;
+
+    // Particle indices sorted by (status, pid, position in the event), with
+    // the matching packed key for each entry.
+    std::vector<int> m_order;
+    std::vector<uint64_t> m_sortedKeys;
+    std::vector<std::pair<uint64_t, int>> m_scratch;
+
+    static uint64_t makeKey(int status, int pid) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(status)) << 32) |
+               static_cast<uint32_t>(pid);
+    }
+};
+
+} // namespace eicQuickSim
+
+#endif // PARTICLEINDEX_H
@@ -0,0 +1,91 @@
+#ifndef TASKQUEUE_H
+#define TASKQUEUE_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eicQuickSim {
+
+/**
+ * A work queue of numbered tasks kept in a directory, shared by any number
+ * of worker processes on one machine or on the nodes of a batch allocation
+ * (the directory only needs to be on a file system they all see).
+ *
+ * Every task is a file that moves between the subdirectories pending/,
+ * running/, done/ and failed/. A worker claims a task by renaming it from
+ * pending/ to running/; rename() is atomic, so exactly one claimer wins and
+ * no locks or server are needed. Workers that finish early simply claim
+ * more, so the load balances itself. A running task is leased: its owner
+ * renews the lease while working on it, and reclaimExpired() puts tasks
+ * whose owner stopped renewing (crashed, killed, node lost) back into
+ * pending/. A task is tried at most maxAttempts times before it is moved to
+ * failed/ with the reason of its last failure.
+ *
+ * Pending tasks are claimed lowest index first, so the producer can order
+ * the tasks by priority (e.g. largest first).
+ */
+class TaskQueue {
+public:
+    struct Task {
+        size_t index = 0;
+        int attempt = 0;   // 0 for the first try
+        std::string lease; // path of the claimed file in running/
+    };
+
+    struct Status {
+        size_t pending = 0;
+        size_t running = 0;
+        size_t done = 0;
+        size_t failed = 0;
+    };
+
+    // Create a queue of nTasks pending tasks in dir. Throws
+    // std::runtime_error if dir already holds a queue or cannot be written.
+    static void create(const std::string& dir, size_t nTasks, int maxAttempts);
+
+    // Open the queue in dir; throws std::runtime_error if there is none.
+    explicit TaskQueue(const std::string& dir);
+
+    size_t size() const { return m_nTasks; }
+    int maxAttempts() const { return m_maxAttempts; }
+
+    // Claim the pending task with the lowest index. Returns false if no
+    // task is pending.
+    bool claim(Task& task);
+    // Extend the lease of a claimed task. Returns false if the lease was
+    // lost, i.e. the task was reclaimed by reclaimExpired().
+    bool renew(const Task& task) const;
+    // Mark a claimed task as done. Returns false if the lease was lost.
+    bool complete(const Task& task) const;
+    // Give a claimed task back after a failed attempt: it is pending again
+    // unless it has used up its attempts, then it is failed. Returns true
+    // if the task will be retried.
+    bool fail(const Task& task, const std::string& reason) const;
+    // Fail every running task whose lease was not renewed for more than
+    // leaseSeconds. Returns the number of reclaimed tasks.
+    size_t reclaimExpired(double leaseSeconds) const;
+
+    Status status() const;
+    // True once every task is done or failed.
+    bool finished() const;
+    // Indices of the failed tasks, ascending, with their last failure.
+    std::vector<std::pair<size_t, std::string>> failedTasks() const;
+
+private:
+    std::string m_dir;
+    size_t m_nTasks;
+    int m_maxAttempts;
+    std::string m_owner; // host and pid of this process
+
+    std::string path(const char* subdir, const std::string& name = "") const;
+    // Parse "<index>.<attempt>[.<owner>]"; false for foreign file names.
+    static bool parseName(const std::string& name, size_t& index, int& attempt);
+    static std::string taskName(size_t index);
+    static std::vector<std::string> list(const std::string& dir);
+};
+
+} // namespace eicQuickSim
+
+#endif // TASKQUEUE_H
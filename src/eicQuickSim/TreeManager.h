@@ -2,16 +2,64 @@
 #define TREEMANAGER_H
 
 #include "Kinematics.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include <utility>
 
 // ROOT headers
 #include "TFile.h"
 #include "TTree.h"
 
+namespace YAML { class Node; }
+
+// Output settings of a TreeManager, read from the optional tree_options
+// block of an analysis YAML:
+//
+//   tree_options:
+//     compression: zstd          # zlib, lzma, lz4, zstd or none (default: ROOT's)
+//     compression_level: 5       # 1-9
+//     basket_size: 64000         # bytes per branch basket
+//     precision: float           # default for every branch: float or double
+//     branch_precision: {weight: double}
+//     branches: [Q2, x, z, weight]   # write only these (default: all)
+//     async: true                # fill the tree on a background thread
+//     block_size: 4096           # rows per block handed to the writer
+//     queue_blocks: 8            # blocks in flight before producers wait
+struct TreeOptions {
+    std::string compression;   // empty: keep ROOT's default
+    int compressionLevel = -1; // -1: the algorithm's default level
+    int basketSize = 32000;
+    std::string precision = "double";
+    std::map<std::string, std::string> branchPrecision;
+    std::vector<std::string> branches;
+    bool async = false;
+    size_t blockSize = 4096;
+    size_t queueBlocks = 8;
+
+    // Throws std::runtime_error on unknown or out-of-range values.
+    static TreeOptions fromYaml(const YAML::Node& node);
+};
+
 class TreeManager {
 public:
+    // Rows handed to the tree, stored column by column in the order of
+    // getBranchNames().
+    struct Block {
+        size_t rows = 0;
+        std::vector<std::vector<double>> columns;
+    };
+
     // Constructor: outputFile is the ROOT file to save the tree, analysisType indicates DIS, SIDIS, or DISIDIS.
-    TreeManager(const std::string& outputFile, const std::string& analysisType);
+    // With resumeEntries > 0 the first resumeEntries entries of the tree already in outputFile
+    // (written by an interrupted run) are carried over. Throws std::runtime_error if they cannot be
+    // read or if options select a branch that does not exist.
+    TreeManager(const std::string& outputFile, const std::string& analysisType,
+                const TreeOptions& options = TreeOptions(), long long resumeEntries = 0);
     ~TreeManager();
 
     // Methods to fill TTree for different kinematics types.
@@ -19,48 +67,94 @@ public:
     void fillSIDIS(const eicQuickSim::sidisKinematics& sid, double eventWeight);
     void fillDISIDIS(const eicQuickSim::dihadronKinematics& dih, double eventWeight);
 
+    // Hand over a block of rows. Thread-safe; in async mode the block is
+    // queued for the writer thread (waiting while the queue is full),
+    // otherwise it is filled right away.
+    void submit(Block&& block);
+    // Start a block laid out for this tree, with room for capacity rows.
+    Block makeBlock(size_t capacity) const;
+    // Append one row to a block made by makeBlock().
+    void appendDIS(Block& block, const eicQuickSim::disKinematics& dis, double eventWeight) const;
+    void appendSIDIS(Block& block, const eicQuickSim::sidisKinematics& sid, double eventWeight) const;
+    void appendDISIDIS(Block& block, const eicQuickSim::dihadronKinematics& dih, double eventWeight) const;
+    size_t blockSize() const { return m_options.blockSize; }
+
     // Write the TTree to the output file and close.
     void saveTree();
 
+    // Flush the baskets and tree header written so far, so that the file is
+    // readable if the job dies (used by checkpoints). Waits until the first
+    // entries rows have been filled; rows submitted later may be included
+    // but are not waited for.
+    void autoSave(long long entries);
+    // Entries submitted so far, including those still queued.
+    long long getEntries() const;
+
+    // Names of the branches written for this analysis type.
+    std::vector<std::string> getBranchNames() const;
+
 private:
+    enum class Type { None, DIS, SIDIS, DISIDIS };
+
+    // One branch. Its source is a member of the kinematics struct of the
+    // analysis type, or the event weight when the member is null.
+    struct Column {
+        std::string name;
+        double eicQuickSim::disKinematics::* dis = nullptr;
+        double eicQuickSim::sidisKinematics::* sidis = nullptr;
+        double eicQuickSim::dihadronKinematics::* dihad = nullptr;
+        bool isFloat = false;
+        double value = 0.0;
+        float floatValue = 0.0f;
+    };
+
     // ROOT objects.
     TFile* m_file;
     TTree* m_tree;
     std::string m_analysisType;
+    Type m_type;
+    TreeOptions m_options;
+    std::vector<Column> m_columns; // selected branches; addresses are bound to the tree
+
+    // m_fillMutex serialises access to the tree; m_queueMutex guards the
+    // writer queue, m_submitted and m_filled.
+    mutable std::mutex m_fillMutex;
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queueCond;
+    std::deque<Block> m_queue;
+    bool m_stopWriter;
+    std::thread m_writer;
+    long long m_submitted;
+    long long m_filled; // rows filled into the tree
 
-    // Common event weight variable.
-    double m_weight;
-
-    // Variables for DIS analysis.
-    double m_dis_Q2;
-    double m_dis_x;
-    double m_dis_y;   
-    double m_dis_W;
-
-    // Variables for SIDIS analysis.
-    double m_sidis_Q2;
-    double m_sidis_x;
-    double m_sidis_y;   
-    double m_sidis_xF;
-    double m_sidis_eta;
-    double m_sidis_z;
-    double m_sidis_phi;
-    double m_sidis_pt_lab;
-    double m_sidis_pt_com;
-
-    // Variables for DISIDIS analysis.
-    double m_dihad_Q2;
-    double m_dihad_x;
-    double m_dihad_y;  
-    double m_dihad_z_pair;
-    double m_dihad_phi_h;
-    double m_dihad_phi_R_method0;
-    double m_dihad_phi_R_method1;
-    double m_dihad_pt_lab_pair;
-    double m_dihad_pt_com_pair;
-    double m_dihad_xF_pair;
-    double m_dihad_com_th;
-    double m_dihad_Mh;
+    void setupColumns();
+    void fillBlock(const Block& block);
+    void writerLoop();
+    void waitFilled(long long entries);
+    void stopWriter();
+};
+
+// Per-thread staging area for tree entries. Worker threads collect their
+// entries here and hand them to the shared TreeManager as columnar blocks,
+// so the event loop never touches the tree itself.
+class TreeBuffer {
+public:
+    void addDIS(const eicQuickSim::disKinematics& dis, double eventWeight);
+    void addSIDIS(const eicQuickSim::sidisKinematics& sid, double eventWeight);
+    void addDISIDIS(const eicQuickSim::dihadronKinematics& dih, double eventWeight);
+
+    size_t size() const;
+    // Drop the buffered entries.
+    void clear();
+
+    // Convert the buffered entries to blocks, submit them to the tree and
+    // clear the buffer. Needs no external locking.
+    void flushTo(TreeManager& treeManager);
+
+private:
+    std::vector<std::pair<eicQuickSim::disKinematics, double>> m_dis;
+    std::vector<std::pair<eicQuickSim::sidisKinematics, double>> m_sidis;
+    std::vector<std::pair<eicQuickSim::dihadronKinematics, double>> m_dihad;
 };
 
 #endif // TREEMANAGER_H
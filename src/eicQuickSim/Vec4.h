@@ -0,0 +1,92 @@
+#ifndef VEC4_H
+#define VEC4_H
+
+#include <cmath>
+
+namespace eicQuickSim {
+
+// Plain three- and four-vectors used in the kinematics hot path in place of
+// TVector3/TLorentzVector. The operations mirror the ROOT implementations
+// term for term, so both give identical results.
+
+struct Vec3 {
+    double x, y, z;
+};
+
+struct Vec4 {
+    double px, py, pz, e;
+
+    Vec3 vect() const { return Vec3{px, py, pz}; }
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return Vec3{a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return Vec3{a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3 operator-(const Vec3& a) { return Vec3{-a.x, -a.y, -a.z}; }
+inline Vec3 operator*(double s, const Vec3& a) { return Vec3{s * a.x, s * a.y, s * a.z}; }
+
+inline double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3{a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y};
+}
+inline double mag2(const Vec3& a) { return a.x * a.x + a.y * a.y + a.z * a.z; }
+inline double mag(const Vec3& a) { return std::sqrt(mag2(a)); }
+
+// Component of a transverse to the given axis (TVector3::Perp(axis)).
+inline double perp(const Vec3& a, const Vec3& axis) {
+    double tot = mag2(axis);
+    double ss = dot(a, axis);
+    double per = mag2(a);
+    if (tot > 0.0) per -= ss * ss / tot;
+    if (per < 0) per = 0;
+    return std::sqrt(per);
+}
+
+// Opening angle between a and b (TVector3::Angle).
+inline double angle(const Vec3& a, const Vec3& b) {
+    double ptot2 = mag2(a) * mag2(b);
+    if (ptot2 <= 0) return 0.0;
+    double arg = dot(a, b) / std::sqrt(ptot2);
+    if (arg > 1.0) arg = 1.0;
+    if (arg < -1.0) arg = -1.0;
+    return std::acos(arg);
+}
+
+inline double pseudoRapidity(const Vec3& a) {
+    double ptot = mag(a);
+    double cosTheta = (ptot == 0.0) ? 1.0 : a.z / ptot;
+    if (cosTheta * cosTheta < 1) return -0.5 * std::log((1.0 - cosTheta) / (1.0 + cosTheta));
+    if (a.z == 0) return 0;
+    return (a.z > 0) ? 10e10 : -10e10;
+}
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) { return Vec4{a.px + b.px, a.py + b.py, a.pz + b.pz, a.e + b.e}; }
+inline Vec4 operator-(const Vec4& a, const Vec4& b) { return Vec4{a.px - b.px, a.py - b.py, a.pz - b.pz, a.e - b.e}; }
+inline Vec4 operator*(double s, const Vec4& a) { return Vec4{s * a.px, s * a.py, s * a.pz, s * a.e}; }
+
+// Minkowski product with (+,-,-,-) metric.
+inline double dot(const Vec4& a, const Vec4& b) { return a.e * b.e - a.pz * b.pz - a.py * b.py - a.px * b.px; }
+inline double m2(const Vec4& a) { return a.e * a.e - mag2(a.vect()); }
+inline double mass(const Vec4& a) {
+    double mm = m2(a);
+    return (mm < 0.0) ? -std::sqrt(-mm) : std::sqrt(mm);
+}
+inline double pt(const Vec4& a) { return std::sqrt(a.px * a.px + a.py * a.py); }
+
+// Velocity of the frame in which a is at rest.
+inline Vec3 boostVector(const Vec4& a) { return Vec3{a.px / a.e, a.py / a.e, a.pz / a.e}; }
+
+// Lorentz boost of a by velocity b (TLorentzVector::Boost).
+inline Vec4 boost(const Vec4& a, const Vec3& b) {
+    double b2 = b.x * b.x + b.y * b.y + b.z * b.z;
+    double gamma = 1.0 / std::sqrt(1.0 - b2);
+    double bp = b.x * a.px + b.y * a.py + b.z * a.pz;
+    double gamma2 = (b2 > 0) ? (gamma - 1.0) / b2 : 0.0;
+    return Vec4{a.px + gamma2 * bp * b.x + gamma * b.x * a.e,
+                a.py + gamma2 * bp * b.y + gamma * b.y * a.e,
+                a.pz + gamma2 * bp * b.z + gamma * b.z * a.e,
+                gamma * (a.e + bp)};
+}
+
+} // namespace eicQuickSim
+
+#endif // VEC4_H
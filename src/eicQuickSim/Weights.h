@@ -16,9 +16,23 @@ public:
     // For modes LUMI_CSV and DEFAULT, combinedRows must be provided.
     // For mode PRECALCULATED, combinedRows can be empty and csvFilename is used to load the precalculated weights.
     Weights(const std::vector<CSVRow>& combinedRows, WeightInitMethod initMethod, const std::string &csvFilename = "");
+
+    // Same, from per-group totals (FileManager::getGroupSummaries or
+    // FileManager::summarizeRows); costs O(groups) instead of O(rows).
+    Weights(const std::vector<CSVGroupSummary>& groups, WeightInitMethod initMethod, const std::string &csvFilename = "");
     
     // Returns the weight for a given Q2 value.
     double getWeight(double Q2) const;
+
+    // The Q2 ranges: getWeight(Q2) is getRangeWeight(getRangeIndex(Q2)).
+    size_t getNumRanges() const { return Q2weights.size(); }
+    size_t getRangeIndex(double Q2) const;
+    double getRangeWeight(size_t range) const;
+
+    // Recompute LUMI_CSV or DEFAULT weights for other event counts per Q2
+    // range, e.g. the events a run actually processed. The groups must have
+    // the Q2 ranges and cross sections the weights were created with.
+    void setEntries(const std::vector<CSVGroupSummary>& groups);
     
     // Exports a CSV file with an appended weight column.
     bool exportCSVWithWeights(const std::vector<CSVRow>& rows, const std::string &outFilePath) const;
@@ -31,7 +45,7 @@ private:
     // Q2 ranges and related data.
     std::vector<double> Q2mins;
     std::vector<double> Q2maxs;
-    std::vector<int> Q2entries;
+    std::vector<long long> Q2entries;
     std::vector<double> Q2xsecs;
     std::vector<double> Q2weights;
     std::vector<double> providedWeights;
@@ -49,10 +63,10 @@ private:
     WeightInitMethod initMethod_;
 
     // Helper functions.
-    void calculateUniqueRanges(const std::vector<CSVRow>& rows);
-    void calculateEntriesAndXsecs(const std::vector<CSVRow>& rows);
+    void calculateUniqueRanges(const std::vector<CSVGroupSummary>& groups);
+    void calculateEntriesAndXsecs(const std::vector<CSVGroupSummary>& groups);
     void determineTotalCrossSection();
-    void calculateWeights();
+    void calculateWeights(bool verbose = true);
     bool inQ2Range(double value, double minVal, double maxVal, bool inclusiveUpper) const;
     
     // Loads experimental luminosity from a CSV file.